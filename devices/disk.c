@@ -7,6 +7,7 @@
 #include "threads/io.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
 
 /* The code in this file is an interface to an ATA (IDE)
    controller.  It attempts to comply to [ATA-3]. */
@@ -120,6 +121,7 @@ disk_init (void) {
 				NOT_REACHED ();
 		}
 		lock_init (&c->lock);
+		lock_profile (&c->lock, c->name);
 		c->expecting_interrupt = false;
 		sema_init (&c->completion_wait, 0);
 
@@ -203,6 +205,12 @@ disk_size (struct disk *d) {
 	return d->capacity;
 }
 
+/* Identifies disk D in a trace record (see threads/trace.h). */
+static uint64_t
+trace_disk_id (const struct disk *d, bool write) {
+	return (d->channel - channels) * 2 + d->dev_no + (write ? 0x100 : 0);
+}
+
 /* Reads sector SEC_NO from disk D into BUFFER, which must have
    room for DISK_SECTOR_SIZE bytes.
    Internally synchronizes accesses to disks, so external
@@ -217,11 +225,13 @@ disk_read (struct disk *d, disk_sector_t sec_no, void *buffer) {
 	c = d->channel;
 	lock_acquire (&c->lock);
 	select_sector (d, sec_no);
+	trace (TRACE_DISK_START, sec_no, trace_disk_id (d, false));
 	issue_pio_command (c, CMD_READ_SECTOR_RETRY);
 	sema_down (&c->completion_wait);
 	if (!wait_while_busy (d))
 		PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name, sec_no);
 	input_sector (c, buffer);
+	trace (TRACE_DISK_DONE, sec_no, trace_disk_id (d, false));
 	d->read_cnt++;
 	lock_release (&c->lock);
 }
@@ -241,11 +251,13 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
 	c = d->channel;
 	lock_acquire (&c->lock);
 	select_sector (d, sec_no);
+	trace (TRACE_DISK_START, sec_no, trace_disk_id (d, true));
 	issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
 	if (!wait_while_busy (d))
 		PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
 	output_sector (c, buffer);
 	sema_down (&c->completion_wait);
+	trace (TRACE_DISK_DONE, sec_no, trace_disk_id (d, true));
 	d->write_cnt++;
 	lock_release (&c->lock);
 }
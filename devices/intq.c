@@ -1,31 +1,85 @@
 #include "devices/intq.h"
 #include <debug.h>
+#include <string.h>
 #include "threads/thread.h"
 
-static int next (int pos);
 static void wait (struct intq *q, struct thread **waiter);
 static void signal (struct intq *q, struct thread **waiter);
 
 /* Initializes interrupt queue Q. */
 void
 intq_init (struct intq *q) {
+	ASSERT ((INTQ_BUFSIZE & (INTQ_BUFSIZE - 1)) == 0);
+
 	lock_init (&q->lock);
 	q->not_full = q->not_empty = NULL;
 	q->head = q->tail = 0;
 }
 
+/* Returns the number of bytes in Q.  Each side sees a count that
+   the other side can only make more favourable to it. */
+static unsigned
+used (const struct intq *q) {
+	return __atomic_load_n (&q->head, __ATOMIC_ACQUIRE)
+		- __atomic_load_n (&q->tail, __ATOMIC_ACQUIRE);
+}
+
 /* Returns true if Q is empty, false otherwise. */
 bool
 intq_empty (const struct intq *q) {
-	ASSERT (intr_get_level () == INTR_OFF);
-	return q->head == q->tail;
+	return used (q) == 0;
 }
 
 /* Returns true if Q is full, false otherwise. */
 bool
 intq_full (const struct intq *q) {
-	ASSERT (intr_get_level () == INTR_OFF);
-	return next (q->head) == q->tail;
+	return used (q) == INTQ_BUFSIZE;
+}
+
+/* Removes up to SIZE bytes from Q into BUF and returns the number
+   removed, which is 0 if Q is empty.  Never sleeps.  Must be called
+   by Q's consumer. */
+size_t
+intq_get (struct intq *q, uint8_t *buf, size_t size) {
+	unsigned tail = q->tail;
+	size_t n = used (q), ofs, chunk;
+
+	if (n > size)
+		n = size;
+	if (n == 0)
+		return 0;
+
+	ofs = tail % INTQ_BUFSIZE;
+	chunk = n < INTQ_BUFSIZE - ofs ? n : INTQ_BUFSIZE - ofs;
+	memcpy (buf, q->buf + ofs, chunk);
+	memcpy (buf + chunk, q->buf, n - chunk);
+	__atomic_store_n (&q->tail, tail + n, __ATOMIC_RELEASE);
+
+	signal (q, &q->not_full);
+	return n;
+}
+
+/* Adds up to SIZE bytes from BUF to the end of Q and returns the
+   number added, which is 0 if Q is full.  Never sleeps.  Must be
+   called by Q's producer. */
+size_t
+intq_put (struct intq *q, const uint8_t *buf, size_t size) {
+	unsigned head = q->head;
+	size_t n = INTQ_BUFSIZE - used (q), ofs, chunk;
+
+	if (n > size)
+		n = size;
+	if (n == 0)
+		return 0;
+
+	ofs = head % INTQ_BUFSIZE;
+	chunk = n < INTQ_BUFSIZE - ofs ? n : INTQ_BUFSIZE - ofs;
+	memcpy (q->buf + ofs, buf, chunk);
+	memcpy (q->buf, buf + chunk, n - chunk);
+	__atomic_store_n (&q->head, head + n, __ATOMIC_RELEASE);
+
+	signal (q, &q->not_empty);
+	return n;
 }
 
 /* Removes a byte from Q and returns it.
@@ -36,17 +90,12 @@ uint8_t
 intq_getc (struct intq *q) {
 	uint8_t byte;
 
-	ASSERT (intr_get_level () == INTR_OFF);
-	while (intq_empty (q)) {
+	while (intq_get (q, &byte, 1) == 0) {
 		ASSERT (!intr_context ());
 		lock_acquire (&q->lock);
 		wait (q, &q->not_empty);
 		lock_release (&q->lock);
 	}
-
-	byte = q->buf[q->tail];
-	q->tail = next (q->tail);
-	signal (q, &q->not_full);
 	return byte;
 }
 
@@ -56,36 +105,32 @@ intq_getc (struct intq *q) {
    removed. */
 void
 intq_putc (struct intq *q, uint8_t byte) {
-	ASSERT (intr_get_level () == INTR_OFF);
-	while (intq_full (q)) {
+	while (intq_put (q, &byte, 1) == 0) {
 		ASSERT (!intr_context ());
 		lock_acquire (&q->lock);
 		wait (q, &q->not_full);
 		lock_release (&q->lock);
 	}
-
-	q->buf[q->head] = byte;
-	q->head = next (q->head);
-	signal (q, &q->not_empty);
-}
-
-/* Returns the position after POS within an intq. */
-static int
-next (int pos) {
-	return (pos + 1) % INTQ_BUFSIZE;
 }
 
 /* WAITER must be the address of Q's not_empty or not_full
-   member.  Waits until the given condition is true. */
+   member.  Waits until the given condition is true, unless it
+   already became true. */
 static void
-wait (struct intq *q UNUSED, struct thread **waiter) {
+wait (struct intq *q, struct thread **waiter) {
+	enum intr_level old_level;
+
 	ASSERT (!intr_context ());
-	ASSERT (intr_get_level () == INTR_OFF);
-	ASSERT ((waiter == &q->not_empty && intq_empty (q))
-			|| (waiter == &q->not_full && intq_full (q)));
+	ASSERT (waiter == &q->not_empty || waiter == &q->not_full);
 
-	*waiter = thread_current ();
-	thread_block ();
+	/* The other side only wakes us from signal(), which runs with
+	   interrupts off, so re-checking here cannot miss a wake-up. */
+	old_level = intr_disable ();
+	if (waiter == &q->not_empty ? intq_empty (q) : intq_full (q)) {
+		*waiter = thread_current ();
+		thread_block ();
+	}
+	intr_set_level (old_level);
 }
 
 /* WAITER must be the address of Q's not_empty or not_full
@@ -94,12 +139,16 @@ wait (struct intq *q UNUSED, struct thread **waiter) {
    the waiting thread. */
 static void
 signal (struct intq *q UNUSED, struct thread **waiter) {
-	ASSERT (intr_get_level () == INTR_OFF);
-	ASSERT ((waiter == &q->not_empty && !intq_empty (q))
-			|| (waiter == &q->not_full && !intq_full (q)));
+	enum intr_level old_level;
+
+	ASSERT (waiter == &q->not_empty || waiter == &q->not_full);
 
+	if (__atomic_load_n (waiter, __ATOMIC_ACQUIRE) == NULL)
+		return;
+	old_level = intr_disable ();
 	if (*waiter != NULL) {
 		thread_unblock (*waiter);
 		*waiter = NULL;
 	}
+	intr_set_level (old_level);
 }
@@ -44,6 +44,14 @@
 /* MODEM Control Register. */
 #define MCR_OUT2 0x08           /* Output line 2. */
 
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01         /* Enable the FIFOs. */
+#define FCR_CLEAR_RX 0x02       /* Clear the receive FIFO. */
+#define FCR_CLEAR_TX 0x04       /* Clear the transmit FIFO. */
+
+/* Size of the 16550A's transmit FIFO, in bytes. */
+#define TX_FIFO_SIZE 16
+
 /* Line Status Register. */
 #define LSR_DR 0x01             /* Data Ready: received data byte is in RBR. */
 #define LSR_THRE 0x20           /* THR Empty. */
@@ -86,6 +94,10 @@ serial_init_queue (void) {
 	ASSERT (mode == POLL);
 
 	intr_register_ext (0x20 + 4, serial_interrupt, "serial");
+	/* With the FIFOs on, every transmit interrupt can hand the UART
+	   up to TX_FIFO_SIZE bytes instead of one.  Received bytes still
+	   raise an interrupt one at a time. */
+	outb (FCR_REG, FCR_ENABLE | FCR_CLEAR_RX | FCR_CLEAR_TX);
 	mode = QUEUE;
 	old_level = intr_disable ();
 	write_ier ();
@@ -122,6 +134,41 @@ serial_putc (uint8_t byte) {
 	intr_set_level (old_level);
 }
 
+/* Sends the SIZE bytes in BUF to the serial port.  In queued mode
+   this copies as many bytes into the transmit queue as fit at once,
+   instead of going through serial_putc() byte by byte. */
+void
+serial_write (const uint8_t *buf, size_t size) {
+	enum intr_level old_level;
+
+	if (mode != QUEUE) {
+		while (size-- > 0)
+			serial_putc (*buf++);
+		return;
+	}
+
+	old_level = intr_disable ();
+	while (size > 0) {
+		size_t n = intq_put (&txq, buf, size);
+		buf += n;
+		size -= n;
+		if (n == 0) {
+			/* The queue is full.  As in serial_putc(), poll a byte
+			   out if interrupts were off, otherwise sleep until
+			   the interrupt handler makes room. */
+			if (old_level == INTR_OFF)
+				putc_poll (intq_getc (&txq));
+			else {
+				write_ier ();
+				intq_putc (&txq, *buf++);
+				size--;
+			}
+		}
+	}
+	write_ier ();
+	intr_set_level (old_level);
+}
+
 /* Flushes anything in the serial buffer out the port in polling
    mode. */
 void
@@ -205,10 +252,16 @@ serial_interrupt (struct intr_frame *f UNUSED) {
 	while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
 		input_putc (inb (RBR_REG));
 
-	/* As long as we have a byte to transmit, and the hardware is
-	   ready to accept a byte for transmission, transmit a byte. */
-	while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0)
-		outb (THR_REG, intq_getc (&txq));
+	/* Once the transmit FIFO has drained, refill it with as many
+	   queued bytes as it holds. */
+	if ((inb (LSR_REG) & LSR_THRE) != 0) {
+		uint8_t burst[TX_FIFO_SIZE];
+		size_t n = intq_get (&txq, burst, sizeof burst);
+		size_t i;
+
+		for (i = 0; i < n; i++)
+			outb (THR_REG, burst[i]);
+	}
 
 	/* Update interrupt enable register based on queue status. */
 	write_ier ();
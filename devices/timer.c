@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/profile.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 /* 8254 타이머 칩의 하드웨어 세부 사항은 [8254]를 참조하세요. */
@@ -170,10 +171,11 @@ void timer_print_stats(void)
 
 /* 타이머 인터럽트 핸들러. */
 static void
-timer_interrupt(struct intr_frame *args UNUSED)
+timer_interrupt(struct intr_frame *args)
 {
 	// 인터럽트를 실행했으니 틱 증가
 
+	profile_sample(args); // -profile이면 끼어든 위치를 기록
 	ticks++; // 시스템이 시작된 이후 경과한 타이머 틱 수를 증가시킴
 	check_thread_tick(ticks);
 	thread_tick(); // 스레드 관련 타이머 기능을 처리 // 스레드 틱도 증가시킴
@@ -25,6 +25,10 @@ static size_t cx, cy;
    The attribute at (x,y) is fb[y][x][1]. */
 static uint8_t (*fb)[COL_CNT][2];
 
+/* False if output to the display is turned off (see vga_disable()). */
+static bool enabled = true;
+
+static void putc_at_cursor (int c);
 static void clear_row (size_t y);
 static void cls (void);
 static void newline (void);
@@ -43,16 +47,48 @@ init (void) {
 	}
 }
 
+/* Turns output to the VGA text display off for good, for headless
+   runs where nobody looks at the screen. */
+void
+vga_disable (void) {
+	enabled = false;
+}
+
 /* Writes C to the VGA text display, interpreting control
    characters in the conventional ways.  */
 void
 vga_putc (int c) {
+	char ch = c;
+	vga_write (&ch, 1);
+}
+
+/* Writes the SIZE characters in BUF to the VGA text display, as
+   vga_putc() would, but moves the hardware cursor only once. */
+void
+vga_write (const char *buf, size_t size) {
+	enum intr_level old_level;
+
+	if (!enabled)
+		return;
+
 	/* Disable interrupts to lock out interrupt handlers
 	   that might write to the console. */
-	enum intr_level old_level = intr_disable ();
+	old_level = intr_disable ();
 
 	init ();
+	while (size-- > 0)
+		putc_at_cursor ((uint8_t) *buf++);
 
+	/* Update cursor position. */
+	move_cursor ();
+
+	intr_set_level (old_level);
+}
+
+/* Writes C at the cursor and advances the cursor, without moving
+   the hardware cursor. */
+static void
+putc_at_cursor (int c) {
 	switch (c) {
 		case '\n':
 			newline ();
@@ -84,11 +120,6 @@ vga_putc (int c) {
 				newline ();
 			break;
 	}
-
-	/* Update cursor position. */
-	move_cursor ();
-
-	intr_set_level (old_level);
 }
 
 /* Clears the screen and moves the cursor to the upper left. */
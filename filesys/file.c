@@ -1,13 +1,20 @@
 #include "filesys/file.h"
 #include <debug.h>
 #include "filesys/inode.h"
+#include "filesys/pipe.h"
 #include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
 
-/* An open file. */
+/* An open file.  It is either a file on disk, with an INODE, or one end
+ * of a pipe, with a PIPE.  A pipe end has no position or length and
+ * only moves data in one direction. */
 struct file {
-	struct inode *inode;        /* File's inode. */
+	struct inode *inode;        /* File's inode, or NULL for a pipe end. */
 	off_t pos;                  /* Current position. */
 	bool deny_write;            /* Has file_deny_write() been called? */
+	struct pipe *pipe;          /* Pipe of a pipe end, or NULL. */
+	bool pipe_writer;           /* Write end of PIPE? */
 };
 
 /* Opens a file for the given INODE, of which it takes ownership,
@@ -20,6 +27,7 @@ file_open (struct inode *inode) {
 		file->inode = inode;
 		file->pos = 0;
 		file->deny_write = false;
+		file->pipe = NULL;
 		return file;
 	} else {
 		inode_close (inode);
@@ -28,10 +36,53 @@ file_open (struct inode *inode) {
 	}
 }
 
+/* Creates a pipe and opens its two ends as *READ_END and *WRITE_END.
+ * Returns false if memory is short. */
+bool
+file_open_pipe (struct file **read_end, struct file **write_end) {
+	struct pipe *pipe = pipe_create ();
+	struct file *r = calloc (1, sizeof *r);
+	struct file *w = calloc (1, sizeof *w);
+	if (pipe == NULL || r == NULL || w == NULL) {
+		if (pipe != NULL) {
+			pipe_close (pipe, false);
+			pipe_close (pipe, true);
+		}
+		free (r);
+		free (w);
+		return false;
+	}
+	r->pipe = w->pipe = pipe;
+	w->pipe_writer = true;
+	*read_end = r;
+	*write_end = w;
+	return true;
+}
+
+/* Opens another file on the same pipe end as FILE. */
+static struct file *
+pipe_reopen (struct file *file) {
+	struct file *nfile = calloc (1, sizeof *nfile);
+	if (nfile != NULL) {
+		nfile->pipe = file->pipe;
+		nfile->pipe_writer = file->pipe_writer;
+		pipe_open (nfile->pipe, nfile->pipe_writer);
+	}
+	return nfile;
+}
+
+/* Returns true if FILE is one end of a pipe. */
+bool
+file_is_pipe (struct file *file) {
+	return file->pipe != NULL;
+}
+
 /* Opens and returns a new file for the same inode as FILE.
  * Returns a null pointer if unsuccessful. */
 struct file *
 file_reopen (struct file *file) {
+	if (file->pipe != NULL)
+		return pipe_reopen (file);
 	return file_open (inode_reopen (file->inode));
 }
 
@@ -39,6 +90,8 @@ file_reopen (struct file *file) {
  * same inode as FILE. Returns a null pointer if unsuccessful. */
 struct file *
 file_duplicate (struct file *file) {
+	if (file->pipe != NULL)
+		return pipe_reopen (file);
 	struct file *nfile = file_open (inode_reopen (file->inode));
 	if (nfile) {
 		nfile->pos = file->pos;
@@ -52,13 +105,17 @@ file_duplicate (struct file *file) {
 void
 file_close (struct file *file) {
 	if (file != NULL) {
-		file_allow_write (file);
-		inode_close (file->inode);
+		if (file->pipe != NULL)
+			pipe_close (file->pipe, file->pipe_writer);
+		else {
+			file_allow_write (file);
+			inode_close (file->inode);
+		}
 		free (file);
 	}
 }
 
-/* Returns the inode encapsulated by FILE. */
+/* Returns the inode encapsulated by FILE, or NULL for a pipe end. */
 struct inode *
 file_get_inode (struct file *file) {
 	return file->inode;
@@ -71,6 +128,8 @@ file_get_inode (struct file *file) {
  * Advances FILE's position by the number of bytes read. */
 off_t
 file_read (struct file *file, void *buffer, off_t size) {
+	if (file->pipe != NULL)
+		return file->pipe_writer ? 0 : pipe_read (file->pipe, buffer, size);
 	off_t bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
 	file->pos += bytes_read;
 	return bytes_read;
@@ -83,6 +142,8 @@ file_read (struct file *file, void *buffer, off_t size) {
  * The file's current position is unaffected. */
 off_t
 file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs) {
+	if (file->pipe != NULL)
+		return 0;
 	return inode_read_at (file->inode, buffer, size, file_ofs);
 }
 
@@ -95,6 +156,8 @@ file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs) {
  * Advances FILE's position by the number of bytes read. */
 off_t
 file_write (struct file *file, const void *buffer, off_t size) {
+	if (file->pipe != NULL)
+		return file->pipe_writer ? pipe_write (file->pipe, buffer, size) : 0;
 	off_t bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
 	file->pos += bytes_written;
 	return bytes_written;
@@ -110,15 +173,56 @@ file_write (struct file *file, const void *buffer, off_t size) {
 off_t
 file_write_at (struct file *file, const void *buffer, off_t size,
 		off_t file_ofs) {
+	if (file->pipe != NULL)
+		return 0;
 	return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Copies up to SIZE bytes from SRC to DST inside the kernel, starting at
+ * each file's current position and advancing both.  Data moves through
+ * one kernel page, which whole sectors are read into and written from
+ * directly, so it never passes through user memory.
+ * Returns the number of bytes copied, which may be less than SIZE at the
+ * end of either file, or -1 if the two ranges overlap in the same file or
+ * no buffer could be allocated. */
+off_t
+file_copy_range (struct file *dst, struct file *src, off_t size) {
+	ASSERT (dst != NULL && src != NULL);
+
+	if (dst->pipe != NULL || src->pipe != NULL)
+		return -1;
+	if (dst->inode == src->inode
+			&& src->pos < dst->pos + size && dst->pos < src->pos + size)
+		return -1;
+
+	uint8_t *buffer = palloc_get_page (0);
+	if (buffer == NULL)
+		return -1;
+
+	off_t bytes_copied = 0;
+	while (bytes_copied < size) {
+		off_t chunk_size = size - bytes_copied < PGSIZE
+			? size - bytes_copied : PGSIZE;
+		off_t n = inode_read_at (src->inode, buffer, chunk_size, src->pos);
+		if (n <= 0)
+			break;
+		n = inode_write_at (dst->inode, buffer, n, dst->pos);
+		src->pos += n;
+		dst->pos += n;
+		bytes_copied += n;
+		if (n < chunk_size)
+			break;
+	}
+	palloc_free_page (buffer);
+	return bytes_copied;
+}
+
 /* Prevents write operations on FILE's underlying inode
  * until file_allow_write() is called or FILE is closed. */
 void
 file_deny_write (struct file *file) {
 	ASSERT (file != NULL);
-	if (!file->deny_write) {
+	if (!file->deny_write && file->pipe == NULL) {
 		file->deny_write = true;
 		inode_deny_write (file->inode);
 	}
@@ -136,10 +240,12 @@ file_allow_write (struct file *file) {
 	}
 }
 
-/* Returns the size of FILE in bytes. */
+/* Returns the size of FILE in bytes, or 0 for a pipe end. */
 off_t
 file_length (struct file *file) {
 	ASSERT (file != NULL);
+	if (file->pipe != NULL)
+		return 0;
 	return inode_length (file->inode);
 }
 
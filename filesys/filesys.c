@@ -7,6 +7,9 @@
 #include "filesys/inode.h"
 #include "filesys/directory.h"
 #include "devices/disk.h"
+#ifdef USERPROG
+#include "userprog/exec-cache.h"
+#endif
 
 /* The disk that contains the file system. */
 struct disk *filesys_disk;
@@ -99,6 +102,12 @@ filesys_remove (const char *name) {
 	bool success = dir != NULL && dir_remove (dir, name);
 	dir_close (dir);
 
+#ifdef USERPROG
+	/* A cached executable image holds its inode open, which would keep
+	 * a removed program's blocks allocated until the image ages out. */
+	if (success)
+		exec_cache_prune ();
+#endif
 	return success;
 }
 
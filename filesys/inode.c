@@ -33,6 +33,7 @@ struct inode {
 	int open_cnt;                       /* Number of openers. */
 	bool removed;                       /* True if deleted, false otherwise. */
 	int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+	unsigned generation;                /* Incremented by every write. */
 	struct inode_disk data;             /* Inode content. */
 };
 
@@ -124,6 +125,7 @@ inode_open (disk_sector_t sector) {
 	inode->sector = sector;
 	inode->open_cnt = 1;
 	inode->deny_write_cnt = 0;
+	inode->generation = 0;
 	inode->removed = false;
 	disk_read (filesys_disk, inode->sector, &inode->data);
 	return inode;
@@ -176,6 +178,20 @@ inode_remove (struct inode *inode) {
 	inode->removed = true;
 }
 
+/* Returns true if INODE has been removed. */
+bool
+inode_is_removed (const struct inode *inode) {
+	return inode->removed;
+}
+
+/* Returns INODE's write generation.  It changes whenever INODE's data
+ * is written, so a value saved along with data derived from INODE's
+ * contents tells whether that data is still current. */
+unsigned
+inode_generation (const struct inode *inode) {
+	return inode->generation;
+}
+
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
  * Returns the number of bytes actually read, which may be less
  * than SIZE if an error occurs or end of file is reached. */
@@ -239,6 +255,8 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 
 	if (inode->deny_write_cnt)
 		return 0;
+	if (size > 0)
+		inode->generation++;
 
 	while (size > 0) {
 		/* Sector to write, starting byte offset within sector. */
@@ -0,0 +1,146 @@
+/* pipe.c: Pipes, one-way byte streams between processes.
+ *
+ * A pipe is a ring of PIPE_SIZE bytes in kernel memory.  Readers block
+ * while it is empty and writers while it is full, so two processes can
+ * stream data to each other without touching the disk.  HEAD and TAIL
+ * only ever grow; the bytes in the ring are [HEAD, TAIL), each stored at
+ * its position modulo PIPE_SIZE.
+ *
+ * The pipe counts the open files on each of its ends.  Once every write
+ * end is closed, reads drain what is left and then return 0; once every
+ * read end is closed, writes fail.  The pipe is freed with its last end. */
+
+#include "filesys/pipe.h"
+#include <debug.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+_Static_assert (PIPE_SIZE == PGSIZE, "a pipe's ring is one page");
+
+struct pipe {
+	uint8_t *buf;               /* Ring of PIPE_SIZE bytes. */
+	size_t head;                /* Total bytes ever read. */
+	size_t tail;                /* Total bytes ever written. */
+	int readers;                /* Open read ends. */
+	int writers;                /* Open write ends. */
+	struct lock lock;           /* Protects all of the above. */
+	struct condition readable;  /* Signaled when data or EOF arrives. */
+	struct condition writable;  /* Signaled when space frees up. */
+};
+
+/* Creates a pipe with one open read end and one open write end.
+ * Returns NULL if memory is short. */
+struct pipe *
+pipe_create (void) {
+	struct pipe *p = malloc (sizeof *p);
+	if (p == NULL)
+		return NULL;
+	p->buf = palloc_get_page (0);
+	if (p->buf == NULL) {
+		free (p);
+		return NULL;
+	}
+	p->head = p->tail = 0;
+	p->readers = p->writers = 1;
+	lock_init (&p->lock);
+	cond_init (&p->readable);
+	cond_init (&p->writable);
+	return p;
+}
+
+/* Records another open write end of P if WRITER, or read end if not. */
+void
+pipe_open (struct pipe *p, bool writer) {
+	lock_acquire (&p->lock);
+	if (writer)
+		p->writers++;
+	else
+		p->readers++;
+	lock_release (&p->lock);
+}
+
+/* Closes a write end of P if WRITER, or a read end if not, and frees P
+ * when no end is left.  Closing the last end of one side wakes the
+ * threads blocked on the other so they can see it. */
+void
+pipe_close (struct pipe *p, bool writer) {
+	lock_acquire (&p->lock);
+	if (writer) {
+		ASSERT (p->writers > 0);
+		if (--p->writers == 0)
+			cond_broadcast (&p->readable, &p->lock);
+	} else {
+		ASSERT (p->readers > 0);
+		if (--p->readers == 0)
+			cond_broadcast (&p->writable, &p->lock);
+	}
+	bool dead = p->readers == 0 && p->writers == 0;
+	lock_release (&p->lock);
+
+	if (dead) {
+		palloc_free_page (p->buf);
+		free (p);
+	}
+}
+
+/* Reads up to SIZE bytes from P into BUFFER.  Blocks until at least one
+ * byte is there, then returns what is available without waiting for
+ * more.  Returns 0 once P is empty and has no write end left. */
+off_t
+pipe_read (struct pipe *p, void *buffer, off_t size) {
+	uint8_t *dst = buffer;
+	off_t bytes_read = 0;
+
+	lock_acquire (&p->lock);
+	while (p->head == p->tail && p->writers > 0 && size > 0)
+		cond_wait (&p->readable, &p->lock);
+
+	while (bytes_read < size && p->head != p->tail) {
+		size_t ofs = p->head % PIPE_SIZE;
+		size_t chunk = p->tail - p->head;
+		if (chunk > PIPE_SIZE - ofs)
+			chunk = PIPE_SIZE - ofs;
+		if (chunk > (size_t) (size - bytes_read))
+			chunk = size - bytes_read;
+		memcpy (dst + bytes_read, p->buf + ofs, chunk);
+		p->head += chunk;
+		bytes_read += chunk;
+	}
+	if (bytes_read > 0)
+		cond_broadcast (&p->writable, &p->lock);
+	lock_release (&p->lock);
+	return bytes_read;
+}
+
+/* Writes SIZE bytes from BUFFER into P, blocking whenever P is full.
+ * Returns SIZE, or fewer bytes if every read end is closed before all
+ * of them are written, in which case the rest is dropped. */
+off_t
+pipe_write (struct pipe *p, const void *buffer, off_t size) {
+	const uint8_t *src = buffer;
+	off_t bytes_written = 0;
+
+	lock_acquire (&p->lock);
+	while (bytes_written < size && p->readers > 0) {
+		if (p->tail - p->head == PIPE_SIZE) {
+			cond_wait (&p->writable, &p->lock);
+			continue;
+		}
+
+		size_t ofs = p->tail % PIPE_SIZE;
+		size_t chunk = PIPE_SIZE - (p->tail - p->head);
+		if (chunk > PIPE_SIZE - ofs)
+			chunk = PIPE_SIZE - ofs;
+		if (chunk > (size_t) (size - bytes_written))
+			chunk = size - bytes_written;
+		memcpy (p->buf + ofs, src + bytes_written, chunk);
+		p->tail += chunk;
+		bytes_written += chunk;
+		cond_broadcast (&p->readable, &p->lock);
+	}
+	lock_release (&p->lock);
+	return bytes_written;
+}
@@ -1,24 +1,32 @@
 #ifndef DEVICES_INTQ_H
 #define DEVICES_INTQ_H
 
+#include <stddef.h>
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 
 /* An "interrupt queue", a circular buffer shared between
    kernel threads and external interrupt handlers.
 
-   Interrupt queue functions can be called from kernel threads or
-   from external interrupt handlers.  Except for intq_init(),
-   interrupts must be off in either case.
-
-   The interrupt queue has the structure of a "monitor".  Locks
-   and condition variables from threads/synch.h cannot be used in
-   this case, as they normally would, because they can only
-   protect kernel threads from one another, not from interrupt
-   handlers. */
-
-/* Queue buffer size, in bytes. */
-#define INTQ_BUFSIZE 64
+   The queue is a single-producer, single-consumer ring: one
+   context puts bytes in and one takes them out.  Only the
+   producer advances the head and only the consumer advances the
+   tail, so the two sides need no lock, and intq_put() and
+   intq_get() move whole runs of bytes without turning interrupts
+   off.  Several threads may share one side only if something else
+   serializes them, e.g. the console lock or disabled interrupts.
+
+   Sleeping is the exception.  A thread that finds the queue empty
+   (in intq_getc()) or full (in intq_putc()) blocks with interrupts
+   off, and the other side wakes it.  Locks and condition variables
+   from threads/synch.h cannot be used for this, as they normally
+   would, because they can only protect kernel threads from one
+   another, not from interrupt handlers. */
+
+/* Queue buffer size, in bytes.  Must be a power of 2. */
+#ifndef INTQ_BUFSIZE
+#define INTQ_BUFSIZE 1024
+#endif
 
 /* A circular queue of bytes. */
 struct intq {
@@ -27,15 +35,18 @@ struct intq {
 	struct thread *not_full;    /* Thread waiting for not-full condition. */
 	struct thread *not_empty;   /* Thread waiting for not-empty condition. */
 
-	/* Queue. */
+	/* Queue.  HEAD and TAIL count the bytes ever added and removed,
+	   so HEAD - TAIL bytes are queued. */
 	uint8_t buf[INTQ_BUFSIZE];  /* Buffer. */
-	int head;                   /* New data is written here. */
-	int tail;                   /* Old data is read here. */
+	unsigned head;              /* Advanced by the producer only. */
+	unsigned tail;              /* Advanced by the consumer only. */
 };
 
 void intq_init (struct intq *);
 bool intq_empty (const struct intq *);
 bool intq_full (const struct intq *);
+size_t intq_get (struct intq *, uint8_t *, size_t);
+size_t intq_put (struct intq *, const uint8_t *, size_t);
 uint8_t intq_getc (struct intq *);
 void intq_putc (struct intq *, uint8_t);
 
@@ -0,0 +1,51 @@
+#ifndef __LIB_IO_RING_H
+#define __LIB_IO_RING_H
+
+#include <stdint.h>
+
+/* Submission/completion rings shared between a user process and the
+ * kernel.  The process fills submission queue entries (SQEs) and
+ * advances SQ_TAIL, then calls io_ring_enter(); the kernel runs the
+ * queued requests in order under one file system lock acquisition and
+ * posts a completion queue entry (CQE) for each, advancing SQ_HEAD and
+ * CQ_TAIL.  The process consumes CQEs and advances CQ_HEAD.  Indexes run
+ * freely and are reduced modulo ENTRIES. */
+
+/* Largest ring io_ring_setup() accepts. */
+#define IO_RING_MAX_ENTRIES 4096
+
+enum io_ring_op {
+	IO_RING_NOP,                /* Does nothing; result 0. */
+	IO_RING_READ,               /* read() or, with OFFSET >= 0, pread(). */
+	IO_RING_WRITE,              /* write() or, with OFFSET >= 0, pwrite(). */
+	IO_RING_OPEN,               /* open() of the file named by BUF. */
+	IO_RING_CLOSE,              /* close() of FD; result 0. */
+};
+
+/* A request. */
+struct io_ring_sqe {
+	uint32_t op;                /* One of enum io_ring_op. */
+	int32_t fd;                 /* File descriptor. */
+	void *buf;                  /* Buffer, or file name for IO_RING_OPEN. */
+	uint32_t len;               /* Bytes to transfer. */
+	int32_t offset;             /* File offset, or -1 for the position. */
+	uint64_t user_data;         /* Copied to the completion unchanged. */
+};
+
+/* The result of a request. */
+struct io_ring_cqe {
+	uint64_t user_data;         /* From the request. */
+	int64_t res;                /* Return value of the operation. */
+};
+
+struct io_ring {
+	uint32_t entries;           /* Size of both queues, a power of two. */
+	uint32_t sq_head;           /* Next SQE to run.  Kernel advances. */
+	uint32_t sq_tail;           /* Next free SQE.  User advances. */
+	uint32_t cq_head;           /* Next CQE to consume.  User advances. */
+	uint32_t cq_tail;           /* Next free CQE.  Kernel advances. */
+	struct io_ring_sqe *sqes;   /* ENTRIES submission queue entries. */
+	struct io_ring_cqe *cqes;   /* ENTRIES completion queue entries. */
+};
+
+#endif /* lib/io-ring.h */
@@ -18,7 +18,13 @@
  * conversion from a struct hash_elem back to a structure object
  * that contains it.  This is the same technique used in the
  * linked list implementation.  Refer to lib/kernel/list.h for a
- * detailed explanation. */
+ * detailed explanation.
+ *
+ * Resizing is incremental.  When the table grows or shrinks, the
+ * old bucket array is kept around and each later insertion or
+ * deletion moves a few of its buckets into the new array, so no
+ * single operation pays for moving every element.  Until the old
+ * array is drained, lookups search both arrays. */
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -59,6 +65,9 @@ struct hash {
 	size_t elem_cnt;            /* Number of elements in table. */
 	size_t bucket_cnt;          /* Number of buckets, a power of 2. */
 	struct list *buckets;       /* Array of `bucket_cnt' lists. */
+	struct list *old_buckets;   /* Array being drained, or NULL. */
+	size_t old_bucket_cnt;      /* Number of `old_buckets', a power of 2. */
+	size_t drain_idx;           /* Next of `old_buckets' to drain. */
 	hash_hash_func *hash;       /* Hash function. */
 	hash_less_func *less;       /* Comparison function. */
 	void *aux;                  /* Auxiliary data for `hash' and `less'. */
@@ -104,6 +104,13 @@ struct list {
 	((STRUCT *) ((uint8_t *) &(LIST_ELEM)->next     \
 		- offsetof (STRUCT, MEMBER.next)))
 
+/* Static initializer for list NAME, for lists that must be usable
+   before any code runs:
+
+   static struct list my_list = LIST_INITIALIZER (my_list); */
+#define LIST_INITIALIZER(NAME) { { NULL, &(NAME).tail }, \
+                                 { &(NAME).head, NULL } }
+
 void list_init (struct list *);
 
 /* List traversal. */
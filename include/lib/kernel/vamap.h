@@ -0,0 +1,58 @@
+#ifndef __LIB_KERNEL_VAMAP_H
+#define __LIB_KERNEL_VAMAP_H
+
+/* Map from page-aligned virtual addresses to non-null pointers.
+ *
+ * Unlike struct hash, this is an open-addressing table: the
+ * address and the value are stored side by side in the slot
+ * array, which is probed linearly.  Entries need no embedded
+ * element, a lookup touches one or two cache lines and never the
+ * mapped objects themselves, and deletion shifts the following
+ * entries back instead of leaving tombstones.
+ *
+ * Like struct hash, the table grows incrementally: when it gets
+ * too full, a slot array twice the size is allocated, and each
+ * later insertion or deletion moves a few entries of the old
+ * array into it.  Lookups search both arrays until the old one
+ * is drained.  The table never shrinks. */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* One slot.  VA is null in an empty slot. */
+struct vamap_slot {
+	const void *va;             /* Page-aligned key. */
+	void *value;                /* Value mapped at VA. */
+};
+
+/* Map. */
+struct vamap {
+	size_t cnt;                 /* Number of entries, in both arrays. */
+	size_t slot_cnt;            /* Number of `slots', a power of 2. */
+	struct vamap_slot *slots;   /* Slot array. */
+	struct vamap_slot *old_slots; /* Array being drained, or NULL. */
+	size_t old_slot_cnt;        /* Number of `old_slots'. */
+	size_t old_cnt;             /* Entries left in `old_slots'. */
+	size_t drain_idx;           /* Next of `old_slots' to drain. */
+};
+
+/* Performs some operation on VALUE, given auxiliary data AUX. */
+typedef void vamap_action_func (void *value, void *aux);
+
+/* Basic life cycle. */
+bool vamap_init (struct vamap *);
+void vamap_clear (struct vamap *, vamap_action_func *, void *aux);
+void vamap_destroy (struct vamap *, vamap_action_func *, void *aux);
+
+/* Search, insertion, deletion. */
+void *vamap_find (const struct vamap *, const void *va);
+bool vamap_insert (struct vamap *, const void *va, void *value);
+void *vamap_delete (struct vamap *, const void *va);
+
+/* Iteration. */
+void vamap_apply (struct vamap *, vamap_action_func *, void *aux);
+
+/* Information. */
+size_t vamap_size (const struct vamap *);
+
+#endif /* lib/kernel/vamap.h */
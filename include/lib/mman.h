@@ -0,0 +1,10 @@
+#ifndef __LIB_MMAN_H
+#define __LIB_MMAN_H
+
+/* File descriptor to pass to mmap() to map anonymous memory instead of
+   a file.  The memory starts out zeroed and, unlike other anonymous
+   memory, stays shared with every child forked afterwards, so writes by
+   any of them are seen by all.  The offset must be 0. */
+#define MAP_SHARED_ANON (-1)
+
+#endif /* lib/mman.h */
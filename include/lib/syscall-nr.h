@@ -36,6 +36,18 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Extensions. */
+	SYS_SPAWN,                  /* Start a process running a new program. */
+	SYS_READV,                  /* Read into several buffers. */
+	SYS_WRITEV,                 /* Write from several buffers. */
+	SYS_PREAD,                  /* Read at a given file offset. */
+	SYS_PWRITE,                 /* Write at a given file offset. */
+	SYS_COPY_FILE_RANGE,        /* Copy data between two files. */
+	SYS_IO_RING_SETUP,          /* Register a batched I/O ring. */
+	SYS_IO_RING_ENTER,          /* Run requests queued on the ring. */
+	SYS_WAITPID,                /* Reap a child, optionally any or without blocking. */
+	SYS_PIPE,                   /* Create a pipe. */
 };
 
 #endif /* lib/syscall-nr.h */
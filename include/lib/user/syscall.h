@@ -4,6 +4,12 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <vm-stat.h>
+#include <iovec.h>
+#include <io-ring.h>
+#include <mman.h>
+#include <wait.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -37,6 +43,16 @@ unsigned tell (int fd);
 void close (int fd);
 
 int dup2(int oldfd, int newfd);
+pid_t spawn (const char *cmd_line, const int *fds, size_t fd_cnt);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int pread (int fd, void *buffer, unsigned length, off_t offset);
+int pwrite (int fd, const void *buffer, unsigned length, off_t offset);
+int copy_file_range (int fd_in, int fd_out, unsigned length);
+int io_ring_setup (struct io_ring *ring);
+int io_ring_enter (unsigned to_submit);
+pid_t waitpid (pid_t pid, int *status, int options);
+int pipe (int fds[2]);
 
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
@@ -78,4 +94,14 @@ get_fs_disk_write_cnt (void) {
 	return write_cnt;
 }
 
+static inline long long
+get_vm_stat (enum vm_stat stat, bool global) {
+	long long value;
+	asm volatile ("movq %1, %%rdx\n\tmovq %2, %%rcx\n\tint $0x45"
+			: "=a" (value)
+			: "r" ((uint64_t) stat), "r" ((uint64_t) global)
+			: "rdx", "rcx", "memory");
+	return value;
+}
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,19 @@
+#ifndef __LIB_VM_STAT_H
+#define __LIB_VM_STAT_H
+
+/* Virtual memory counters, readable from user programs via int 0x45. */
+enum vm_stat {
+	VM_STAT_FAULTS,             /* Page faults handled. */
+	VM_STAT_MAJOR_FAULTS,       /* Faults that had to read from disk. */
+	VM_STAT_MINOR_FAULTS,       /* Faults resolved without disk I/O. */
+	VM_STAT_EVICTIONS,          /* Frames evicted. */
+	VM_STAT_SWAP_INS,           /* Pages read back from the swap disk. */
+	VM_STAT_SWAP_OUTS,          /* Pages written out to the swap disk. */
+	VM_STAT_ZSWAP_LOADS,        /* Pages brought back from the zswap cache. */
+	VM_STAT_ZSWAP_STORES,       /* Pages evicted into the zswap cache. */
+	VM_STAT_STACK_GROWTHS,      /* Stack growth events. */
+	VM_STAT_ZERO_MAPS,          /* Reads served by the shared zero page. */
+	VM_STAT_CNT
+};
+
+#endif /* lib/vm-stat.h */
@@ -0,0 +1,10 @@
+#ifndef __LIB_WAIT_H
+#define __LIB_WAIT_H
+
+/* Special PID for waitpid(): wait for any child. */
+#define WAIT_ANY (-1)
+
+/* Options for waitpid(). */
+#define WNOHANG 1               /* Return 0 instead of blocking. */
+
+#endif /* lib/wait.h */
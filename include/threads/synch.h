@@ -3,11 +3,12 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include "threads/waitq.h"
 
 /* A counting semaphore. */
 struct semaphore {
 	unsigned value;             /* Current value. */
-	struct list waiters;        /* List of waiting threads. */
+	struct waitq waiters;       /* Waiting threads, by priority. */
 };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -20,9 +21,21 @@ void sema_self_test (void);
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+
+	/* Contention profile, kept for every lock.  Only locks passed to
+	   lock_profile() are reported by lock_print_stats(). */
+	const char *name;           /* Name, or NULL if not reported. */
+	struct list_elem prof_elem; /* Element in the list of reported locks. */
+	int64_t acquired_at;        /* Tick at which HOLDER took the lock. */
+	long long acquire_cnt;      /* Number of acquisitions. */
+	long long contended_cnt;    /* Acquisitions that had to sleep. */
+	int64_t wait_ticks;         /* Total ticks spent sleeping on it. */
+	int64_t max_hold_ticks;     /* Longest time it was held. */
 };
 
 void lock_init (struct lock *);
+void lock_profile (struct lock *, const char *name);
+void lock_print_stats (void);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
@@ -30,7 +43,7 @@ bool lock_held_by_current_thread (const struct lock *);
 
 /* Condition variable. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct waitq waiters;       /* Waiting semaphore_elems, by priority. */
 };
 
 void cond_init (struct condition *);
@@ -38,6 +51,23 @@ void cond_wait (struct condition *, struct lock *);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Reader-writer lock. */
+struct rwlock {
+	struct lock lock;           /* Held by the writer, briefly by readers. */
+	int readers;                /* Number of threads holding it to read. */
+	bool writer_waiting;        /* Writer waiting for readers to leave? */
+	struct semaphore drained;   /* Upped when the last reader leaves. */
+};
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_read (struct rwlock *);
+bool rwlock_try_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+bool rwlock_try_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_held_by_current_thread (const struct rwlock *);
+
 /* Optimization barrier.
  *
  * The compiler will not reorder operations across an
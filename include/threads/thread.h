@@ -6,9 +6,14 @@
 #include <stdint.h>
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+
+struct trace_buf;
 #ifdef VM
 #include "vm/vm.h"
 #endif
+#ifdef USERPROG
+#include "userprog/fdt.h"
+#endif
 
 /* States in a thread's life cycle. */
 enum thread_status
@@ -23,8 +28,6 @@ enum thread_status
    You can redefine this to whatever type you like. */
 typedef int tid_t;
 #define TID_ERROR ((tid_t) - 1) /* Error value for tid_t. */
-#define FDT_PAGES 2
-#define FDT_COUNT_LIMIT 128
 /* Thread priorities. */
 #define PRI_MIN 0	   /* Lowest priority. */
 #define PRI_DEFAULT 31 /* Default priority. */
@@ -81,12 +84,12 @@ typedef int tid_t;
  * the `magic' member of the running thread's `struct thread' is
  * set to THREAD_MAGIC.  Stack overflow will normally change this
  * value, triggering the assertion. */
-/* The `elem' member has a dual purpose.  It can be an element in
- * the run queue (thread.c), or it can be an element in a
- * semaphore wait list (synch.c).  It can be used these two ways
- * only because they are mutually exclusive: only a thread in the
- * ready state is on the run queue, whereas only a thread in the
- * blocked state is on a semaphore wait list. */
+/* The `elem' member is an element in the run queue or the sleep
+ * list (thread.c).  A thread blocked on a semaphore is instead on
+ * the semaphore's wait queue through `wait_elem' (synch.c), and
+ * while it waits on a condition variable `cond_elem' points to its
+ * entry in the condition's queue, so that priority donation can
+ * move it within both. */
 struct thread
 {
 	/* Owned by thread.c. */
@@ -100,8 +103,12 @@ struct thread
 	struct list donations;
 	struct list_elem donation_elem;
 
+	struct trace_buf *trace; /* 이벤트 추적 링(trace.c), 없으면 NULL. */
+
 	/* Shared between thread.c and synch.c. */
 	struct list_elem elem; /* List element. */
+	struct waitq_elem wait_elem;   /* Semaphore wait queue element. */
+	struct waitq_elem *cond_elem;  /* Condition queue entry, or NULL. */
 
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
@@ -112,14 +119,18 @@ struct thread
 	struct supplemental_page_table spt;
 	void *rsp;
 	void* stack_bottom;
+	long long vm_stats[VM_STAT_CNT]; /* Per-thread VM counters. */
 #endif
 
 	/* Owned by thread.c. */
 	struct intr_frame tf; /* Information for switching */
 
-	/* 파일 디스크럽터 테이블 & 다음에 저장될 fd를 저장해준다. */
-	struct file **fdt;
-	int next_fd;
+#ifdef USERPROG
+	/* 파일 디스크럽터 테이블. */
+	struct fd_table fdt;
+	/* io_ring_setup()으로 등록한 사용자 영역의 링, 없으면 NULL. */
+	struct io_ring *io_ring;
+#endif
 
 	// 자식 프로세스 생성시
 	// 부모 프로세스의 사용자 영역 스택을 물려줘야하는데
@@ -127,15 +138,14 @@ struct thread
 	// 사용자 영역 즉 sys_handler에 인자인 intr_frame을
 	// 자식 프로세스에게 넘겨줘야힘
 	struct intr_frame parent_if;
+#ifdef USERPROG
+	// 자식들의 종료 기록(struct child_record). 종료한 자식의 기록이 앞에 온다.
 	struct list child_list;
-	struct list_elem child_elem;
-	// 자식 프로세스가 생성되자마자
-	// _do_fork 가 호출되어 load가 진행됨
-	// 부모스레드는 load가 완료될때까지 기다려야함
-	// 세마포어 사용하자
-	struct semaphore load_sema;
-	struct semaphore exit_sema;
-	struct semaphore wait_sema;
+	// 자식이 종료할 때마다 올라간다. 기다리는 부모는 깨어나서 목록을 다시 본다.
+	struct semaphore child_sema;
+	// 부모가 가진 이 스레드의 종료 기록. 부모 없이 만든 스레드는 NULL.
+	struct child_record *record;
+#endif
 	unsigned magic; /* Detects stack overflow. */
 	int exit_status;
 
@@ -155,6 +165,9 @@ void thread_print_stats(void);
 
 typedef void thread_func(void *aux);
 tid_t thread_create(const char *name, int priority, thread_func *, void *);
+#ifdef USERPROG
+tid_t thread_create_child(const char *name, int priority, thread_func *, void *);
+#endif
 
 void thread_block(void);
 void thread_unblock(struct thread *);
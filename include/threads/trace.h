@@ -0,0 +1,34 @@
+#ifndef THREADS_TRACE_H
+#define THREADS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct thread;
+
+/* Kinds of trace records.  The meaning of ARG0 and ARG1 is given
+   for each; utils/pintos-trace decodes them by these numbers. */
+enum trace_type {
+	TRACE_SWITCH = 1,           /* Switching away.  ARG0: next tid,
+	                               ARG1: new status of the old thread. */
+	TRACE_FAULT,                /* Page fault.  ARG0: 1 if write, plus 2
+	                               if user.  ARG1: fault address. */
+	TRACE_EVICT,                /* Frame evicted.  ARG1: evicted page. */
+	TRACE_DISK_START,           /* Disk I/O issued.  ARG0: sector, ARG1:
+	                               disk (channel * 2 + device), plus
+	                               0x100 for writes. */
+	TRACE_DISK_DONE,            /* Disk I/O completed.  Same as above. */
+	TRACE_LOCK_WAIT,            /* Sleeping on a lock.  ARG1: the lock. */
+	TRACE_LOCK_ACQUIRE,         /* Got the lock waited for.  ARG1: lock. */
+};
+
+extern bool trace_enabled;
+
+void trace_init (void);
+void trace_attach (struct thread *);
+void trace_thread (struct thread *, enum trace_type,
+		uint32_t arg0, uint64_t arg1);
+void trace (enum trace_type, uint32_t arg0, uint64_t arg1);
+void trace_dump (void);
+
+#endif /* threads/trace.h */
@@ -0,0 +1,46 @@
+#ifndef THREADS_WAITQ_H
+#define THREADS_WAITQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Priority-ordered queue of waiting threads.
+ *
+ * Waiters are kept in a pairing heap, so queuing one is O(1) and taking
+ * out the one with the highest priority is O(log n) amortized.  That
+ * bounds the time sema_up() and cond_signal() spend with interrupts off,
+ * however many threads wait.  Waiters of equal priority leave in the
+ * order they arrived.
+ *
+ * Each element remembers the priority it was queued with.  When a
+ * waiting thread's priority changes, e.g. by donation, waitq_update()
+ * moves it to its new place.  All functions must be called with
+ * interrupts off. */
+struct waitq_elem {
+	int priority;               /* Priority the waiter is ordered by. */
+	uint64_t seq;               /* Arrival order, for ties. */
+	struct waitq *queue;        /* Queue this element is on, or NULL. */
+	struct waitq_elem *child;   /* First child in the heap. */
+	struct waitq_elem *next;    /* Next sibling. */
+	struct waitq_elem *prev;    /* Previous sibling, or parent. */
+};
+
+struct waitq {
+	struct waitq_elem *root;    /* Waiter to wake next, or NULL. */
+	uint64_t next_seq;          /* Arrival number of the next waiter. */
+};
+
+/* Converts pointer to waitq element WAITQ_ELEM into a pointer to the
+   structure that WAITQ_ELEM is embedded inside. */
+#define waitq_entry(WAITQ_ELEM, STRUCT, MEMBER)           \
+	((STRUCT *) ((uint8_t *) (WAITQ_ELEM)                 \
+		- offsetof (STRUCT, MEMBER)))
+
+void waitq_init (struct waitq *);
+bool waitq_empty (const struct waitq *);
+void waitq_push (struct waitq *, struct waitq_elem *, int priority);
+struct waitq_elem *waitq_pop (struct waitq *);
+void waitq_update (struct waitq_elem *, int priority);
+
+#endif /* threads/waitq.h */
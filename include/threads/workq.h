@@ -0,0 +1,24 @@
+#ifndef THREADS_WORKQ_H
+#define THREADS_WORKQ_H
+
+#include <list.h>
+#include "threads/synch.h"
+
+/* Deferred work, run by a kernel worker thread (see workq.c). */
+typedef void work_func (void *aux);
+
+/* A unit of deferred work.  The submitter owns the memory and must
+   keep it alive until the work has run. */
+struct work {
+	work_func *func;            /* Function to run. */
+	void *aux;                  /* Argument to FUNC. */
+	struct semaphore *done;     /* Upped after FUNC returns, or NULL. */
+	struct list_elem elem;      /* Element in a worker's deque. */
+};
+
+void workq_init (void);
+void work_init (struct work *, work_func *, void *aux,
+		struct semaphore *done);
+void workq_submit (struct work *);
+
+#endif /* threads/workq.h */
@@ -0,0 +1,42 @@
+#ifndef USERPROG_EXEC_CACHE_H
+#define USERPROG_EXEC_CACHE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "filesys/off_t.h"
+
+struct inode;
+
+/* A loadable segment of an executable, already validated and rounded
+ * to pages. */
+struct exec_segment {
+	off_t file_page;            /* Page-aligned offset in the file. */
+	void *mem_page;             /* Page-aligned user virtual address. */
+	uint32_t read_bytes;        /* Bytes read from the file. */
+	uint32_t zero_bytes;        /* Bytes zeroed after READ_BYTES. */
+	bool writable;
+};
+
+/* The parsed headers of an ELF executable: everything load() needs to
+ * map the program without reading the file again. */
+struct exec_image {
+	uintptr_t entry;            /* Entry point. */
+	size_t seg_cnt;             /* Number of loadable segments. */
+	struct exec_segment *segs;  /* Loadable segments, from malloc(). */
+
+	/* Owned by exec-cache.c. */
+	struct inode *inode;        /* Executable, held open.  Cache key. */
+	unsigned generation;        /* inode_generation() when parsed. */
+	int refs;                   /* References, one of them the cache's. */
+	struct list_elem elem;      /* Cache LRU list. */
+};
+
+void exec_cache_init (void);
+struct exec_image *exec_cache_lookup (struct inode *);
+struct exec_image *exec_cache_insert (struct inode *, struct exec_image *);
+void exec_cache_prune (void);
+void exec_cache_put (struct exec_image *);
+
+#endif /* userprog/exec-cache.h */
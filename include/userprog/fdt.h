@@ -0,0 +1,42 @@
+#ifndef USERPROG_FDT_H
+#define USERPROG_FDT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct file;
+
+/* Most descriptors a process can have open at once. */
+#define FDT_COUNT_LIMIT 4096
+
+/* Descriptors 0 and 1 are the console.  They are never handed out by
+ * fdt_add(), but dup2() may put a file there, which then takes the place
+ * of the console until it is closed. */
+#define FDT_FIRST_FD 2
+
+/* File descriptor table of a process.
+ *
+ * FILES is allocated on the first open and doubles in size as needed.
+ * Bit N of USED is set while descriptor N is taken, which the console
+ * descriptors always are, and bit W of FULL is
+ * set while word W of USED has no free bit, so the lowest free descriptor
+ * is found with two bit scans no matter how many are open.  FULL has one
+ * bit per 64 descriptors, which bounds the table at FDT_COUNT_LIMIT. */
+struct fd_table {
+	struct file **files;        /* FILES[N] is descriptor N, or NULL. */
+	uint64_t *used;             /* Descriptors in use. */
+	uint64_t full;              /* Words of USED that are full. */
+	int size;                   /* Capacity of FILES, a multiple of 64. */
+};
+
+void fdt_init (struct fd_table *t);
+void fdt_destroy (struct fd_table *t);
+bool fdt_duplicate (struct fd_table *dst, const struct fd_table *src);
+
+int fdt_add (struct fd_table *t, struct file *file);
+bool fdt_install (struct fd_table *t, int fd, struct file *file);
+struct file *fdt_get (const struct fd_table *t, int fd);
+struct file *fdt_remove (struct fd_table *t, int fd);
+int fdt_next (const struct fd_table *t, int fd);
+
+#endif /* userprog/fdt.h */
@@ -2,15 +2,33 @@
 #define USERPROG_PROCESS_H
 
 #include "threads/thread.h"
+#include "threads/synch.h"
+
+/* 자식 스레드의 종료 기록.  자식이 끝나도 부모가 거둘 때까지 남으므로,
+ * 자식은 부모를 기다리지 않고 종료하자마자 스레드와 자원을 모두
+ * 반납할 수 있습니다.  부모와 자식이 참조를 하나씩 가지며 둘 다 놓으면
+ * 해제됩니다.  모든 필드는 인터럽트를 끈 채로 다룹니다. */
+struct child_record
+{
+    tid_t tid;
+    int exit_status;              /* EXITED일 때만 의미가 있다. */
+    bool exited;
+    int refs;                     /* 아직 놓지 않은 쪽(부모, 자식)의 수. */
+    struct thread *parent;        /* 부모가 먼저 종료하면 NULL. */
+    struct semaphore load_sema;   /* fork, spawn에서 자식이 로드를 마치면 올린다. */
+    struct list_elem elem;        /* 부모의 child_list. */
+};
 
 tid_t process_create_initd (const char *file_name);
 tid_t process_fork (const char *name, struct intr_frame *if_);
+tid_t process_spawn (char *cmd_line, const int *fds, size_t fd_cnt);
 int process_exec (void *f_name);
 int process_wait (tid_t);
+tid_t process_waitpid (tid_t, int *status, bool nohang);
+bool process_add_child (struct thread *child);
 void process_exit (void);
 void process_activate (struct thread *next);
 void argument_stack(char **parse, int count, void **rsp);
-struct thread *get_child_process(int pid);
 
 int process_add_file(struct file *f);
 struct file *process_get_file(int fd);
@@ -1,7 +1,16 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct file;
+
 void syscall_init (void);
+bool needs_filesys_lock (struct file *file);
+int user_io (struct file *file, void *ubuf, size_t size,
+		off_t offset, bool is_write, void *bounce);
 extern struct lock filesys_lock;
 
 #endif /* userprog/syscall.h */
\ No newline at end of file
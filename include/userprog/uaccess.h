@@ -0,0 +1,19 @@
+#ifndef USERPROG_UACCESS_H
+#define USERPROG_UACCESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* An exception table entry.  A kernel page fault at instruction INSN
+ * that the VM system cannot resolve resumes at FIXUP instead. */
+struct exception_entry {
+	uintptr_t insn;
+	uintptr_t fixup;
+};
+
+bool copy_from_user (void *dst, const void *usrc, size_t size);
+bool copy_to_user (void *udst, const void *src, size_t size);
+int strncpy_from_user (char *dst, const char *usrc, size_t size);
+
+#endif /* userprog/uaccess.h */
@@ -8,10 +8,12 @@ struct page;
 enum vm_type;
 
 struct anon_page {
-    int bit_idx;
+    int bit_idx;        /* Swap slot on disk, or -1. */
+    int zswap_idx;      /* Entry in the compressed cache, or -1. */
 };
 
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
+bool anon_swap_copy (struct page *page, void *kva);
 
 #endif
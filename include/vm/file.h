@@ -11,9 +11,6 @@ struct file_page {
 	struct file *file;
 	off_t ofs;
 	
-	void *file_start_page;
-	void *file_end_page;
-	
 	size_t page_read_bytes;
 	size_t page_zero_bytes;
 };
@@ -0,0 +1,30 @@
+#ifndef VM_SHM_H
+#define VM_SHM_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "threads/synch.h"
+
+/* Anonymous memory shared between processes.  Every region mapping it
+ * holds a reference, and fork() gives the child's copy of the region
+ * another one, so parent and child map the very same frames.
+ *
+ * Frames are allocated zeroed on first touch and stay resident until
+ * the last reference is dropped: they are not in the frame table and
+ * are never evicted, since a shared frame would have to be unmapped
+ * from every process that maps it. */
+struct shm {
+	size_t page_cnt;            /* Size in pages. */
+	void **frames;              /* Kernel address of each page, or NULL. */
+	int refs;                   /* Regions that map this memory. */
+	struct lock lock;           /* Protects FRAMES and REFS. */
+};
+
+struct vm_area;
+
+void *do_mmap_shared (void *addr, void *end, bool writable);
+struct shm *shm_ref (struct shm *);
+void shm_put (struct shm *);
+void *shm_get_frame (struct shm *, size_t idx);
+void shm_unmap (struct vm_area *);
+
+#endif /* vm/shm.h */
@@ -3,7 +3,8 @@
 #include <stdbool.h>
 #include "threads/palloc.h"
 
-#include <hash.h>
+#include <vamap.h>
+#include <vm-stat.h>
 
 enum vm_type {
 	/* page not initialized */
@@ -29,6 +30,7 @@ enum vm_type {
 #include "vm/uninit.h"
 #include "vm/anon.h"
 #include "vm/file.h"
+#include "vm/vma.h"
 #ifdef EFILESYS
 #include "filesys/page_cache.h"
 #endif
@@ -48,7 +50,8 @@ struct page {
 	struct frame *frame;   /* Back reference for frame */
 
 	/* Your implementation */
-	struct hash_elem page_elem; /*해시 테이블 요소*/
+	struct vm_area *area;       /* Region this page belongs to. */
+	struct list_elem area_elem; /* Element of area->pages. */
 	// bool is_present;
 	bool is_writable;
 	// bool is_user;
@@ -73,6 +76,7 @@ struct page {
 struct frame {
 	void *kva;
 	struct page *page;
+	uint64_t *pml4;          /* Page table that maps PAGE to KVA. */
 	struct list_elem frame_elem;
 };
 
@@ -87,17 +91,6 @@ struct page_operations {
 	enum vm_type type;
 };
 
-// for aux
-struct load_info{
-	struct file *file;
-	size_t page_read_bytes;
-	size_t page_zero_bytes;
-	off_t ofs;
-	bool writable;
-	size_t file_start_page;
-	size_t file_end_page;
-};
-
 #define swap_in(page, v) (page)->operations->swap_in ((page), v)
 #define swap_out(page) (page)->operations->swap_out (page)
 #define destroy(page) \
@@ -107,11 +100,14 @@ struct load_info{
  * We don't want to force you to obey any specific design for this struct.
  * All designs up to you for this. */
 struct supplemental_page_table {
-	struct hash pages;
+	struct vamap pages;         /* Materialized pages, keyed by va. */
+	struct vm_area *areas;      /* Root of the region interval tree. */
+	struct vm_area *stack;      /* Region of the user stack. */
+	bool dying;                 /* Being torn down as a whole? */
 };
 
 #include "threads/thread.h"
-void supplemental_page_table_init (struct supplemental_page_table *spt);
+bool supplemental_page_table_init (struct supplemental_page_table *spt);
 bool supplemental_page_table_copy (struct supplemental_page_table *dst,
 		struct supplemental_page_table *src);
 void supplemental_page_table_kill (struct supplemental_page_table *spt);
@@ -131,6 +127,12 @@ bool vm_alloc_page_with_initializer (enum vm_type type, void *upage,
 void vm_dealloc_page (struct page *page);
 bool vm_claim_page (void *va);
 enum vm_type page_get_type (struct page *page);
-void page_dealloc(struct hash_elem *e, void *aux);
+void page_dealloc(void *page_, void *aux);
+void vm_free_frame (struct page *page);
+void vm_unmap_zero (struct page *page);
+
+void vm_stat_inc (enum vm_stat stat);
+long long vm_stat_get (enum vm_stat stat, bool global);
+void vm_print_stats (void);
 
 #endif  /* VM_VM_H */
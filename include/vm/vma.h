@@ -0,0 +1,62 @@
+#ifndef VM_VMA_H
+#define VM_VMA_H
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "filesys/off_t.h"
+
+struct file;
+struct page;
+struct shm;
+struct supplemental_page_table;
+enum vm_type;
+
+/* A contiguous region of user virtual memory, [START, END), whose pages
+ * share a type, a backing file and permissions.  Regions are created by
+ * load(), mmap() and the stack, and `struct page`s are only materialized
+ * for the pages of a region that have actually been touched.  A region
+ * of shared anonymous memory has no pages at all: its frames belong to
+ * SHM and are mapped directly (see vm/shm.c).
+ *
+ * Regions of one address space never overlap.  They are kept in an AVL
+ * tree ordered by START and augmented with the largest END of each
+ * subtree, so that overlap queries are O(log n). */
+struct vm_area {
+	void *start;                /* First page of the region. */
+	void *end;                  /* One past the last page. */
+	enum vm_type type;          /* Type of the pages (VM_ANON, VM_FILE). */
+	bool writable;              /* Writable by the user? */
+
+	struct file *file;          /* Backing file owned by region, or NULL. */
+	off_t ofs;                  /* File offset of START. */
+	size_t read_bytes;          /* Bytes read from FILE; rest is zeroed. */
+
+	struct shm *shm;            /* Shared memory mapped here, or NULL. */
+	struct list pages;          /* Materialized pages (page->area_elem). */
+
+	/* Interval tree links. */
+	struct vm_area *left;
+	struct vm_area *right;
+	void *max_end;              /* Largest END in this subtree. */
+	int height;
+};
+
+struct vm_area *vma_create (struct supplemental_page_table *spt,
+		void *start, void *end, enum vm_type type, bool writable,
+		struct file *file, off_t ofs, size_t read_bytes);
+void vma_destroy (struct supplemental_page_table *spt, struct vm_area *area);
+void vma_kill_all (struct supplemental_page_table *spt);
+
+struct vm_area *vma_find (struct supplemental_page_table *spt,
+		const void *va);
+bool vma_overlaps (struct supplemental_page_table *spt,
+		const void *start, const void *end);
+struct vm_area *vma_first (struct supplemental_page_table *spt);
+struct vm_area *vma_next (struct supplemental_page_table *spt,
+		struct vm_area *area);
+bool vma_extend_down (struct supplemental_page_table *spt,
+		struct vm_area *area, void *new_start);
+
+bool vma_load_page (struct page *page, void *aux);
+
+#endif /* vm/vma.h */
@@ -0,0 +1,14 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+#include <stdbool.h>
+
+/* Compressed in-memory cache for evicted anonymous pages.  Pages are
+ * stored here first and only go to the swap disk when the cache is full
+ * or they do not compress. */
+
+void zswap_init (void);
+int zswap_store (const void *kva);
+bool zswap_load (int idx, void *kva);
+void zswap_free (int idx);
+
+#endif /* vm/zswap.h */
@@ -1,6 +1,7 @@
 #include <console.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include "devices/serial.h"
 #include "devices/vga.h"
 #include "threads/init.h"
@@ -9,6 +10,18 @@
 
 static void vprintf_helper (char, void *);
 static void putchar_have_lock (uint8_t c);
+static void write_have_lock (const char *, size_t);
+
+/* Size of the buffer vprintf() collects output in. */
+#define CONSOLE_BUF_SIZE 128
+
+/* Output of one vprintf() call on its way to the devices.  It is
+   written out a line at a time, or whenever BUF fills up. */
+struct console_buf {
+	int char_cnt;               /* Characters printed so far. */
+	size_t len;                 /* Characters waiting in BUF. */
+	char buf[CONSOLE_BUF_SIZE];
+};
 
 /* The console lock.
    Both the vga and serial layers do their own locking, so it's
@@ -63,6 +76,7 @@ static int64_t write_cnt;
 void
 console_init (void) {
 	lock_init (&console_lock);
+	lock_profile (&console_lock, "console");
 	use_console_lock = true;
 }
 
@@ -116,13 +130,17 @@ console_locked_by_current_thread (void) {
    Writes its output to both vga display and serial port. */
 int
 vprintf (const char *format, va_list args) {
-	int char_cnt = 0;
+	struct console_buf cb;
+
+	cb.char_cnt = 0;
+	cb.len = 0;
 
 	acquire_console ();
-	__vprintf (format, args, vprintf_helper, &char_cnt);
+	__vprintf (format, args, vprintf_helper, &cb);
+	write_have_lock (cb.buf, cb.len);
 	release_console ();
 
-	return char_cnt;
+	return cb.char_cnt;
 }
 
 /* Writes string S to the console, followed by a new-line
@@ -130,8 +148,7 @@ vprintf (const char *format, va_list args) {
 int
 puts (const char *s) {
 	acquire_console ();
-	while (*s != '\0')
-		putchar_have_lock (*s++);
+	write_have_lock (s, strlen (s));
 	putchar_have_lock ('\n');
 	release_console ();
 
@@ -142,8 +159,7 @@ puts (const char *s) {
 void
 putbuf (const char *buffer, size_t n) {
 	acquire_console ();
-	while (n-- > 0)
-		putchar_have_lock (*buffer++);
+	write_have_lock (buffer, n);
 	release_console ();
 }
 
@@ -159,10 +175,15 @@ putchar (int c) {
 
 /* Helper function for vprintf(). */
 static void
-vprintf_helper (char c, void *char_cnt_) {
-	int *char_cnt = char_cnt_;
-	(*char_cnt)++;
-	putchar_have_lock (c);
+vprintf_helper (char c, void *cb_) {
+	struct console_buf *cb = cb_;
+
+	cb->char_cnt++;
+	cb->buf[cb->len++] = c;
+	if (c == '\n' || cb->len == sizeof cb->buf) {
+		write_have_lock (cb->buf, cb->len);
+		cb->len = 0;
+	}
 }
 
 /* Writes C to the vga display and serial port.
@@ -175,3 +196,14 @@ putchar_have_lock (uint8_t c) {
 	serial_putc (c);
 	vga_putc (c);
 }
+
+/* Writes the N characters in BUFFER to the vga display and serial
+   port, handing each device the whole run at once.  The caller
+   has already acquired the console lock if appropriate. */
+static void
+write_have_lock (const char *buffer, size_t n) {
+	ASSERT (console_locked_by_current_thread ());
+	write_cnt += n;
+	serial_write ((const uint8_t *) buffer, n);
+	vga_write (buffer, n);
+}
@@ -12,12 +12,16 @@
 #define list_elem_to_hash_elem(LIST_ELEM)                       \
 	list_entry(LIST_ELEM, struct hash_elem, list_elem)
 
-static struct list *find_bucket (struct hash *, struct hash_elem *);
+static struct list *find_bucket (struct hash *, struct list *, size_t,
+		struct hash_elem *);
 static struct hash_elem *find_elem (struct hash *, struct list *,
 		struct hash_elem *);
+static struct hash_elem *lookup (struct hash *, struct hash_elem *,
+		struct list **);
 static void insert_elem (struct hash *, struct list *, struct hash_elem *);
 static void remove_elem (struct hash *, struct hash_elem *);
 static void rehash (struct hash *);
+static void drain (struct hash *, size_t);
 
 /* Initializes hash table H to compute hash values using HASH and
    compare hash elements using LESS, given auxiliary data AUX. */
@@ -27,6 +31,9 @@ hash_init (struct hash *h,
 	h->elem_cnt = 0;
 	h->bucket_cnt = 4;
 	h->buckets = malloc (sizeof *h->buckets * h->bucket_cnt);
+	h->old_buckets = NULL;
+	h->old_bucket_cnt = 0;
+	h->drain_idx = 0;
 	h->hash = hash;
 	h->less = less;
 	h->aux = aux;
@@ -51,6 +58,22 @@ void
 hash_clear (struct hash *h, hash_action_func *destructor) {
 	size_t i;
 
+	if (h->old_buckets != NULL) {
+		if (destructor != NULL)
+			for (i = h->drain_idx; i < h->old_bucket_cnt; i++) {
+				struct list *bucket = &h->old_buckets[i];
+
+				while (!list_empty (bucket)) {
+					struct list_elem *list_elem = list_pop_front (bucket);
+					destructor (list_elem_to_hash_elem (list_elem), h->aux);
+				}
+			}
+		free (h->old_buckets);
+		h->old_buckets = NULL;
+		h->old_bucket_cnt = 0;
+		h->drain_idx = 0;
+	}
+
 	for (i = 0; i < h->bucket_cnt; i++) {
 		struct list *bucket = &h->buckets[i];
 
@@ -81,6 +104,7 @@ void
 hash_destroy (struct hash *h, hash_action_func *destructor) {
 	if (destructor != NULL)
 		hash_clear (h, destructor);
+	free (h->old_buckets);
 	free (h->buckets);
 }
 
@@ -90,8 +114,8 @@ hash_destroy (struct hash *h, hash_action_func *destructor) {
    without inserting NEW. */
 struct hash_elem *
 hash_insert (struct hash *h, struct hash_elem *new) {
-	struct list *bucket = find_bucket (h, new);
-	struct hash_elem *old = find_elem (h, bucket, new);
+	struct list *bucket;
+	struct hash_elem *old = lookup (h, new, &bucket);
 
 	if (old == NULL)
 		insert_elem (h, bucket, new);
@@ -105,8 +129,8 @@ hash_insert (struct hash *h, struct hash_elem *new) {
    already in the table, which is returned. */
 struct hash_elem *
 hash_replace (struct hash *h, struct hash_elem *new) {
-	struct list *bucket = find_bucket (h, new);
-	struct hash_elem *old = find_elem (h, bucket, new);
+	struct list *bucket;
+	struct hash_elem *old = lookup (h, new, &bucket);
 
 	if (old != NULL)
 		remove_elem (h, old);
@@ -121,7 +145,8 @@ hash_replace (struct hash *h, struct hash_elem *new) {
    null pointer if no equal element exists in the table. */
 struct hash_elem *
 hash_find (struct hash *h, struct hash_elem *e) {
-	return find_elem (h, find_bucket (h, e), e);
+	struct list *bucket;
+	return lookup (h, e, &bucket);
 }
 
 /* Finds, removes, and returns an element equal to E in hash
@@ -133,7 +158,8 @@ hash_find (struct hash *h, struct hash_elem *e) {
    responsibility to deallocate them. */
 struct hash_elem *
 hash_delete (struct hash *h, struct hash_elem *e) {
-	struct hash_elem *found = find_elem (h, find_bucket (h, e), e);
+	struct list *bucket;
+	struct hash_elem *found = lookup (h, e, &bucket);
 	if (found != NULL) {
 		remove_elem (h, found);
 		rehash (h);
@@ -153,6 +179,16 @@ hash_apply (struct hash *h, hash_action_func *action) {
 
 	ASSERT (action != NULL);
 
+	for (i = h->drain_idx; i < h->old_bucket_cnt; i++) {
+		struct list *bucket = &h->old_buckets[i];
+		struct list_elem *elem, *next;
+
+		for (elem = list_begin (bucket); elem != list_end (bucket); elem = next) {
+			next = list_next (elem);
+			action (list_elem_to_hash_elem (elem), h->aux);
+		}
+	}
+
 	for (i = 0; i < h->bucket_cnt; i++) {
 		struct list *bucket = &h->buckets[i];
 		struct list_elem *elem, *next;
@@ -187,7 +223,8 @@ hash_first (struct hash_iterator *i, struct hash *h) {
 	ASSERT (h != NULL);
 
 	i->hash = h;
-	i->bucket = i->hash->buckets;
+	i->bucket = (h->old_buckets != NULL
+			? h->old_buckets + h->drain_idx : h->buckets);
 	i->elem = list_elem_to_hash_elem (list_head (i->bucket));
 }
 
@@ -205,7 +242,17 @@ hash_next (struct hash_iterator *i) {
 
 	i->elem = list_elem_to_hash_elem (list_next (&i->elem->list_elem));
 	while (i->elem == list_elem_to_hash_elem (list_end (i->bucket))) {
-		if (++i->bucket >= i->hash->buckets + i->hash->bucket_cnt) {
+		struct hash *h = i->hash;
+
+		/* Walk the array being drained, if any, then the current one.
+		   The two arrays are separate allocations, so each bound is
+		   checked against its own array. */
+		if (h->old_buckets != NULL
+				&& i->bucket >= h->old_buckets
+				&& i->bucket < h->old_buckets + h->old_bucket_cnt) {
+			if (++i->bucket == h->old_buckets + h->old_bucket_cnt)
+				i->bucket = h->buckets;
+		} else if (++i->bucket >= h->buckets + h->bucket_cnt) {
 			i->elem = NULL;
 			break;
 		}
@@ -276,11 +323,13 @@ hash_int (int i) {
 	return hash_bytes (&i, sizeof i);
 }
 
-/* Returns the bucket in H that E belongs in. */
+/* Returns the bucket among the BUCKET_CNT BUCKETS of H that E
+   belongs in. */
 static struct list *
-find_bucket (struct hash *h, struct hash_elem *e) {
-	size_t bucket_idx = h->hash (e, h->aux) & (h->bucket_cnt - 1);
-	return &h->buckets[bucket_idx];
+find_bucket (struct hash *h, struct list *buckets, size_t bucket_cnt,
+		struct hash_elem *e) {
+	size_t bucket_idx = h->hash (e, h->aux) & (bucket_cnt - 1);
+	return &buckets[bucket_idx];
 }
 
 /* Searches BUCKET in H for a hash element equal to E.  Returns
@@ -297,6 +346,23 @@ find_elem (struct hash *h, struct list *bucket, struct hash_elem *e) {
 	return NULL;
 }
 
+/* Searches H for a hash element equal to E, in the current
+   bucket array and, while a rehash is in progress, in the one
+   being drained.  Stores the current bucket that E belongs in
+   into *BUCKET.  Returns the element if found or a null pointer
+   otherwise. */
+static struct hash_elem *
+lookup (struct hash *h, struct hash_elem *e, struct list **bucket) {
+	struct hash_elem *found;
+
+	*bucket = find_bucket (h, h->buckets, h->bucket_cnt, e);
+	found = find_elem (h, *bucket, e);
+	if (found == NULL && h->old_buckets != NULL)
+		found = find_elem (h, find_bucket (h, h->old_buckets,
+					h->old_bucket_cnt, e), e);
+	return found;
+}
+
 /* Returns X with its lowest-order bit set to 1 turned off. */
 static inline size_t
 turn_off_least_1bit (size_t x) {
@@ -314,20 +380,31 @@ is_power_of_2 (size_t x) {
 #define BEST_ELEMS_PER_BUCKET 2 /* Ideal elems/bucket. */
 #define MAX_ELEMS_PER_BUCKET  4 /* Elems/bucket > 4: increase # of buckets. */
 
+/* Old buckets moved into the new array by each insertion or
+   deletion while a rehash is in progress. */
+#define DRAIN_BUCKETS_PER_OP  4
+
 /* Changes the number of buckets in hash table H to match the
    ideal.  This function can fail because of an out-of-memory
    condition, but that'll just make hash accesses less efficient;
-   we can still continue. */
+   we can still continue.
+
+   The elements are not moved here: the old array is kept and
+   drained a few buckets at a time, by this call and by the
+   insertions and deletions that follow.  While it is being
+   drained, the bucket count is left alone. */
 static void
 rehash (struct hash *h) {
 	size_t old_bucket_cnt, new_bucket_cnt;
-	struct list *new_buckets, *old_buckets;
+	struct list *new_buckets;
 	size_t i;
 
 	ASSERT (h != NULL);
 
-	/* Save old bucket info for later use. */
-	old_buckets = h->buckets;
+	if (h->old_buckets != NULL) {
+		drain (h, DRAIN_BUCKETS_PER_OP);
+		return;
+	}
 	old_bucket_cnt = h->bucket_cnt;
 
 	/* Calculate the number of buckets to use now.
@@ -355,27 +432,39 @@ rehash (struct hash *h) {
 	for (i = 0; i < new_bucket_cnt; i++)
 		list_init (&new_buckets[i]);
 
-	/* Install new bucket info. */
+	/* Install new bucket info, keeping the old buckets for
+	   draining. */
+	h->old_buckets = h->buckets;
+	h->old_bucket_cnt = old_bucket_cnt;
+	h->drain_idx = 0;
 	h->buckets = new_buckets;
 	h->bucket_cnt = new_bucket_cnt;
 
-	/* Move each old element into the appropriate new bucket. */
-	for (i = 0; i < old_bucket_cnt; i++) {
-		struct list *old_bucket;
-		struct list_elem *elem, *next;
+	drain (h, DRAIN_BUCKETS_PER_OP);
+}
 
-		old_bucket = &old_buckets[i];
-		for (elem = list_begin (old_bucket);
-				elem != list_end (old_bucket); elem = next) {
-			struct list *new_bucket
-				= find_bucket (h, list_elem_to_hash_elem (elem));
-			next = list_next (elem);
-			list_remove (elem);
+/* Moves the elements of up to CNT of the old buckets of H into
+   the appropriate new buckets, and frees the old bucket array
+   once it is empty. */
+static void
+drain (struct hash *h, size_t cnt) {
+	while (cnt-- > 0 && h->drain_idx < h->old_bucket_cnt) {
+		struct list *old_bucket = &h->old_buckets[h->drain_idx++];
+
+		while (!list_empty (old_bucket)) {
+			struct list_elem *elem = list_pop_front (old_bucket);
+			struct list *new_bucket = find_bucket (h, h->buckets,
+					h->bucket_cnt, list_elem_to_hash_elem (elem));
 			list_push_front (new_bucket, elem);
 		}
 	}
 
-	free (old_buckets);
+	if (h->drain_idx == h->old_bucket_cnt) {
+		free (h->old_buckets);
+		h->old_buckets = NULL;
+		h->old_bucket_cnt = 0;
+		h->drain_idx = 0;
+	}
 }
 
 /* Inserts E into BUCKET (in hash table H). */
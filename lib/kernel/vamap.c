@@ -0,0 +1,277 @@
+/* Map from page-aligned virtual addresses to pointers.
+
+   See vamap.h for basic information. */
+
+#include "vamap.h"
+#include "../debug.h"
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/vaddr.h"
+
+/* Number of slots in a new map. */
+#define MIN_SLOTS 16
+
+/* Old slots moved into the new array by each insertion or
+   deletion while the map is growing. */
+#define DRAIN_SLOTS_PER_OP 16
+
+/* Marks a slot of the old array whose entry was deleted or has
+   been drained, so that later lookups neither find it nor stop
+   probing there.  No page-aligned address equals it.  The current
+   array never holds tombstones. */
+#define TOMBSTONE ((const void *) 1)
+
+static struct vamap_slot *alloc_slots (size_t slot_cnt);
+static size_t home_of (const void *va, size_t slot_cnt);
+static struct vamap_slot *find_slot (struct vamap_slot *, size_t slot_cnt,
+		const void *va);
+static void put (struct vamap_slot *, size_t slot_cnt, const void *va,
+		void *value);
+static void erase (struct vamap_slot *, size_t slot_cnt,
+		struct vamap_slot *);
+static bool grow (struct vamap *);
+static void drain (struct vamap *, size_t);
+
+/* Initializes MAP as an empty map.  Returns false if memory for
+   the slot array cannot be allocated.  MAP may then still be
+   cleared, applied to or destroyed, but nothing else. */
+bool
+vamap_init (struct vamap *map) {
+	map->cnt = 0;
+	map->slots = alloc_slots (MIN_SLOTS);
+	map->slot_cnt = map->slots != NULL ? MIN_SLOTS : 0;
+	map->old_slots = NULL;
+	map->old_slot_cnt = 0;
+	map->old_cnt = 0;
+	map->drain_idx = 0;
+	return map->slots != NULL;
+}
+
+/* Removes every entry from MAP.  If DESTRUCTOR is non-null, it is
+   first called for each value, given AUX.  Modifying MAP from
+   DESTRUCTOR yields undefined behavior. */
+void
+vamap_clear (struct vamap *map, vamap_action_func *destructor, void *aux) {
+	if (destructor != NULL)
+		vamap_apply (map, destructor, aux);
+
+	free (map->old_slots);
+	map->old_slots = NULL;
+	map->old_slot_cnt = 0;
+	map->old_cnt = 0;
+	map->drain_idx = 0;
+
+	memset (map->slots, 0, sizeof *map->slots * map->slot_cnt);
+	map->cnt = 0;
+}
+
+/* Destroys MAP, first calling DESTRUCTOR, if non-null, for each
+   value as vamap_clear() does. */
+void
+vamap_destroy (struct vamap *map, vamap_action_func *destructor, void *aux) {
+	if (destructor != NULL)
+		vamap_apply (map, destructor, aux);
+	free (map->old_slots);
+	free (map->slots);
+	map->old_slots = map->slots = NULL;
+	map->cnt = map->old_cnt = 0;
+}
+
+/* Returns the value mapped at VA in MAP, or a null pointer if VA
+   is not mapped.  The null address is never mapped. */
+void *
+vamap_find (const struct vamap *map, const void *va) {
+	struct vamap_slot *s;
+
+	ASSERT (pg_ofs (va) == 0);
+
+	s = find_slot (map->slots, map->slot_cnt, va);
+	if (s == NULL && map->old_slots != NULL)
+		s = find_slot (map->old_slots, map->old_slot_cnt, va);
+	return s != NULL ? s->value : NULL;
+}
+
+/* Maps VA to VALUE in MAP.  Returns false, leaving MAP unchanged,
+   if VA is already mapped or if MAP is full and cannot grow. */
+bool
+vamap_insert (struct vamap *map, const void *va, void *value) {
+	ASSERT (va != NULL && pg_ofs (va) == 0);
+	ASSERT (value != NULL);
+
+	if (vamap_find (map, va) != NULL)
+		return false;
+
+	/* Keep the load factor at most 3/4.  If growing fails, carry on
+	   with a fuller table as long as an empty slot remains to end
+	   every probe. */
+	if ((map->cnt + 1) * 4 > map->slot_cnt * 3 && !grow (map)
+			&& map->cnt + 1 >= map->slot_cnt)
+		return false;
+
+	put (map->slots, map->slot_cnt, va, value);
+	map->cnt++;
+	drain (map, DRAIN_SLOTS_PER_OP);
+	return true;
+}
+
+/* Removes VA from MAP and returns the value it was mapped to, or
+   a null pointer if VA was not mapped. */
+void *
+vamap_delete (struct vamap *map, const void *va) {
+	struct vamap_slot *s;
+	void *value;
+
+	ASSERT (pg_ofs (va) == 0);
+
+	if ((s = find_slot (map->slots, map->slot_cnt, va)) != NULL) {
+		value = s->value;
+		erase (map->slots, map->slot_cnt, s);
+	} else if (map->old_slots != NULL
+			&& (s = find_slot (map->old_slots, map->old_slot_cnt, va)) != NULL) {
+		value = s->value;
+		s->va = TOMBSTONE;
+		map->old_cnt--;
+	} else
+		return NULL;
+
+	map->cnt--;
+	drain (map, DRAIN_SLOTS_PER_OP);
+	return value;
+}
+
+/* Calls ACTION for each value in MAP in arbitrary order, given
+   AUX.  Modifying MAP from ACTION yields undefined behavior. */
+void
+vamap_apply (struct vamap *map, vamap_action_func *action, void *aux) {
+	size_t i;
+
+	ASSERT (action != NULL);
+
+	for (i = map->drain_idx; i < map->old_slot_cnt; i++) {
+		struct vamap_slot *s = &map->old_slots[i];
+		if (s->va != NULL && s->va != TOMBSTONE)
+			action (s->value, aux);
+	}
+	for (i = 0; i < map->slot_cnt; i++)
+		if (map->slots[i].va != NULL)
+			action (map->slots[i].value, aux);
+}
+
+/* Returns the number of entries in MAP. */
+size_t
+vamap_size (const struct vamap *map) {
+	return map->cnt;
+}
+
+/* Returns a zeroed array of SLOT_CNT slots, or a null pointer if
+   memory is exhausted. */
+static struct vamap_slot *
+alloc_slots (size_t slot_cnt) {
+	return calloc (slot_cnt, sizeof (struct vamap_slot));
+}
+
+/* Returns the slot that VA hashes to in an array of SLOT_CNT
+   slots.  This is Fibonacci hashing of the page number: the
+   multiplication spreads consecutive pages, whose numbers differ
+   only in their low bits, across the whole array. */
+static size_t
+home_of (const void *va, size_t slot_cnt) {
+	uint64_t h = ((uint64_t) va >> PGBITS) * 0x9e3779b97f4a7c15ULL;
+	return (h ^ (h >> 32)) & (slot_cnt - 1);
+}
+
+/* Returns the slot holding VA in the SLOT_CNT SLOTS, or a null
+   pointer if there is none. */
+static struct vamap_slot *
+find_slot (struct vamap_slot *slots, size_t slot_cnt, const void *va) {
+	size_t i;
+
+	for (i = home_of (va, slot_cnt); slots[i].va != NULL;
+			i = (i + 1) & (slot_cnt - 1))
+		if (slots[i].va == va)
+			return &slots[i];
+	return NULL;
+}
+
+/* Stores VA and VALUE in the first free slot of the SLOT_CNT
+   SLOTS at or after VA's home.  VA must not be present. */
+static void
+put (struct vamap_slot *slots, size_t slot_cnt, const void *va,
+		void *value) {
+	size_t i;
+
+	for (i = home_of (va, slot_cnt); slots[i].va != NULL;
+			i = (i + 1) & (slot_cnt - 1))
+		continue;
+	slots[i].va = va;
+	slots[i].value = value;
+}
+
+/* Empties slot S of the SLOT_CNT SLOTS.  Entries after S in the
+   same run whose home is at or before S are shifted back, so that
+   every entry stays reachable from its home without tombstones. */
+static void
+erase (struct vamap_slot *slots, size_t slot_cnt, struct vamap_slot *s) {
+	size_t mask = slot_cnt - 1;
+	size_t hole = s - slots;
+	size_t i;
+
+	for (i = (hole + 1) & mask; slots[i].va != NULL; i = (i + 1) & mask) {
+		/* Distance of slot I and of the hole from I's home, along the
+		   probe sequence.  The entry may move to the hole only if the
+		   hole lies between its home and I. */
+		size_t home = home_of (slots[i].va, slot_cnt);
+		if (((hole - home) & mask) < ((i - home) & mask)) {
+			slots[hole] = slots[i];
+			hole = i;
+		}
+	}
+	slots[hole].va = NULL;
+	slots[hole].value = NULL;
+}
+
+/* Starts moving MAP to a slot array twice the size.  A growth
+   that is still in progress is completed first.  Returns false if
+   memory is exhausted. */
+static bool
+grow (struct vamap *map) {
+	struct vamap_slot *slots;
+
+	slots = alloc_slots (map->slot_cnt * 2);
+	if (slots == NULL)
+		return false;
+	if (map->old_slots != NULL)
+		drain (map, map->old_slot_cnt);
+
+	map->old_slots = map->slots;
+	map->old_slot_cnt = map->slot_cnt;
+	map->old_cnt = map->cnt;
+	map->drain_idx = 0;
+	map->slots = slots;
+	map->slot_cnt *= 2;
+	return true;
+}
+
+/* Moves the entries of up to CNT old slots of MAP into the current
+   array, and frees the old array once it is empty. */
+static void
+drain (struct vamap *map, size_t cnt) {
+	if (map->old_slots == NULL)
+		return;
+
+	while (cnt-- > 0 && map->old_cnt > 0) {
+		struct vamap_slot *s = &map->old_slots[map->drain_idx++];
+		if (s->va != NULL && s->va != TOMBSTONE) {
+			put (map->slots, map->slot_cnt, s->va, s->value);
+			s->va = TOMBSTONE;
+			map->old_cnt--;
+		}
+	}
+
+	if (map->old_cnt == 0) {
+		free (map->old_slots);
+		map->old_slots = NULL;
+		map->old_slot_cnt = 0;
+		map->drain_idx = 0;
+	}
+}
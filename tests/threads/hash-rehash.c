@@ -0,0 +1,118 @@
+/* Grows a hash table far past its initial size and shrinks it
+   again, deleting and looking up elements along the way, so that
+   many operations run while an incremental rehash is still
+   draining the old bucket array.  Checks that lookups, insertions,
+   deletions, hash_apply() and iterators all see exactly the
+   elements that should be present. */
+
+#include <stdio.h>
+#include <hash.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+
+#define ELEM_CNT 4096
+
+struct value 
+  {
+    struct hash_elem elem;
+    int key;
+    bool present;
+  };
+
+static struct value values[ELEM_CNT];
+static size_t applied;
+
+static uint64_t
+value_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  return hash_int (hash_entry (e, struct value, elem)->key);
+}
+
+static bool
+value_less (const struct hash_elem *a, const struct hash_elem *b,
+            void *aux UNUSED) 
+{
+  return (hash_entry (a, struct value, elem)->key
+          < hash_entry (b, struct value, elem)->key);
+}
+
+static void
+count (struct hash_elem *e UNUSED, void *aux UNUSED) 
+{
+  applied++;
+}
+
+/* Checks that H holds exactly the values marked present, LIVE of
+   them. */
+static void
+check (struct hash *h, size_t live) 
+{
+  struct hash_iterator i;
+  size_t iterated = 0;
+  int k;
+
+  for (k = 0; k < ELEM_CNT; k++)
+    if ((hash_find (h, &values[k].elem) != NULL) != values[k].present)
+      fail ("Lookup of %d returned the wrong result.", k);
+  if (hash_size (h) != live)
+    fail ("Table holds %zu elements, expected %zu.", hash_size (h), live);
+
+  applied = 0;
+  hash_apply (h, count);
+  hash_first (&i, h);
+  while (hash_next (&i))
+    iterated++;
+  if (applied != live || iterated != live)
+    fail ("Visited %zu and iterated %zu elements, expected %zu.",
+          applied, iterated, live);
+}
+
+void
+test_hash_rehash (void) 
+{
+  struct hash h;
+  size_t live = 0;
+  int k;
+
+  if (!hash_init (&h, value_hash, value_less, NULL))
+    fail ("hash_init failed.");
+
+  for (k = 0; k < ELEM_CNT; k++)
+    values[k].key = k;
+
+  for (k = 0; k < ELEM_CNT; k++) 
+    {
+      if (hash_insert (&h, &values[k].elem) != NULL)
+        fail ("Element %d was already present.", k);
+      values[k].present = true;
+      live++;
+      if (k % 3 == 0 && k > 0) 
+        {
+          int victim = k / 2;
+
+          if (hash_delete (&h, &values[victim].elem) != &values[victim].elem)
+            fail ("Deleting element %d failed.", victim);
+          values[victim].present = false;
+          live--;
+        }
+      if (k % 512 == 0)
+        check (&h, live);
+    }
+  check (&h, live);
+  msg ("Inserted %d elements, %zu left after deletions.", ELEM_CNT, live);
+
+  for (k = 0; k < ELEM_CNT; k++)
+    if (values[k].present && k % 4 != 0) 
+      {
+        if (hash_delete (&h, &values[k].elem) != &values[k].elem)
+          fail ("Deleting element %d failed.", k);
+        values[k].present = false;
+        live--;
+        if (k % 512 == 1)
+          check (&h, live);
+      }
+  check (&h, live);
+  msg ("Shrank to %zu elements.", live);
+
+  hash_destroy (&h, NULL);
+}
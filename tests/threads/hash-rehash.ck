@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(hash-rehash) begin
+(hash-rehash) Inserted 4096 elements, 2731 left after deletions.
+(hash-rehash) Shrank to 683 elements.
+(hash-rehash) end
+EOF
+pass;
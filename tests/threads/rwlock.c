@@ -0,0 +1,73 @@
+/* Tests reader-writer locks: readers share the lock, a waiting
+   writer holds off new readers, and threads waiting for a writer
+   donate their priority to it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func reader_thread;
+static thread_func writer_thread;
+static struct rwlock rw;
+
+void
+test_rwlock (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rw);
+
+  /* A reader waiting for the writer donates to it. */
+  rwlock_acquire_write (&rw);
+  msg ("Main thread acquired the lock for writing.");
+  if (rwlock_try_acquire_read (&rw))
+    fail ("Read lock acquired while a writer holds it.");
+  thread_create ("reader 1", PRI_DEFAULT + 5, reader_thread, NULL);
+  msg ("Main thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 5, thread_get_priority ());
+  rwlock_release_write (&rw);
+  msg ("Main thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+
+  /* Readers share the lock. */
+  rwlock_acquire_read (&rw);
+  msg ("Main thread acquired the lock for reading.");
+  if (!rwlock_try_acquire_read (&rw))
+    fail ("Second read lock not acquired.");
+  rwlock_release_read (&rw);
+  if (rwlock_try_acquire_write (&rw))
+    fail ("Write lock acquired while a reader holds it.");
+
+  /* A waiting writer goes before readers that arrive after it. */
+  thread_create ("writer", PRI_DEFAULT + 2, writer_thread, NULL);
+  thread_create ("reader 2", PRI_DEFAULT + 1, reader_thread, NULL);
+  msg ("Main thread releasing the read lock.");
+  rwlock_release_read (&rw);
+  msg ("Main thread finished.");
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  msg ("Thread %s acquiring the lock for reading.", thread_name ());
+  rwlock_acquire_read (&rw);
+  msg ("Thread %s acquired the lock for reading.", thread_name ());
+  rwlock_release_read (&rw);
+  msg ("Thread %s finished.", thread_name ());
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  msg ("Thread writer acquiring the lock for writing.");
+  rwlock_acquire_write (&rw);
+  msg ("Thread writer acquired the lock for writing.");
+  rwlock_release_write (&rw);
+  msg ("Thread writer finished.");
+}
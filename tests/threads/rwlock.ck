@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock) begin
+(rwlock) Main thread acquired the lock for writing.
+(rwlock) Thread reader 1 acquiring the lock for reading.
+(rwlock) Main thread should have priority 36.  Actual priority: 36.
+(rwlock) Thread reader 1 acquired the lock for reading.
+(rwlock) Thread reader 1 finished.
+(rwlock) Main thread should have priority 31.  Actual priority: 31.
+(rwlock) Main thread acquired the lock for reading.
+(rwlock) Thread writer acquiring the lock for writing.
+(rwlock) Thread reader 2 acquiring the lock for reading.
+(rwlock) Main thread releasing the read lock.
+(rwlock) Thread writer acquired the lock for writing.
+(rwlock) Thread writer finished.
+(rwlock) Thread reader 2 acquired the lock for reading.
+(rwlock) Thread reader 2 finished.
+(rwlock) Main thread finished.
+(rwlock) end
+EOF
+pass;
@@ -0,0 +1,74 @@
+/* Fills a virtual address map far past its initial size, so that
+   it grows several times, while deleting every third address and
+   looking addresses up in between.  Checks that every lookup,
+   insertion and deletion sees exactly the addresses that should
+   be present, including while a growth is being drained. */
+
+#include <stdio.h>
+#include <vamap.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/vaddr.h"
+
+#define PAGE_CNT 4096
+
+static char present[PAGE_CNT];
+
+static void *
+page_va (int i) 
+{
+  return (void *) ((uintptr_t) (i + 1) << PGBITS);
+}
+
+static void
+count (void *value UNUSED, void *aux) 
+{
+  (*(size_t *) aux)++;
+}
+
+void
+test_vamap (void) 
+{
+  struct vamap map;
+  size_t live = 0, applied = 0;
+  int i;
+
+  if (!vamap_init (&map))
+    fail ("vamap_init failed.");
+
+  for (i = 0; i < PAGE_CNT; i++) 
+    {
+      if (!vamap_insert (&map, page_va (i), &present[i]))
+        fail ("Inserting page %d failed.", i);
+      present[i] = 1;
+      live++;
+      if (vamap_insert (&map, page_va (i), &present[i]))
+        fail ("Page %d was inserted twice.", i);
+      if (i % 3 == 0 && i > 0) 
+        {
+          int victim = i / 2;
+
+          if (vamap_delete (&map, page_va (victim)) != &present[victim])
+            fail ("Deleting page %d failed.", victim);
+          if (vamap_delete (&map, page_va (victim)) != NULL)
+            fail ("Page %d was deleted twice.", victim);
+          present[victim] = 0;
+          live--;
+        }
+    }
+  msg ("Inserted %d pages, %zu left after deletions.", PAGE_CNT, live);
+
+  for (i = 0; i < PAGE_CNT; i++)
+    if ((vamap_find (&map, page_va (i)) != NULL) != present[i])
+      fail ("Lookup of page %d returned the wrong result.", i);
+  if (vamap_size (&map) != live)
+    fail ("Map holds %zu pages, expected %zu.", vamap_size (&map), live);
+  msg ("Every lookup matched.");
+
+  vamap_apply (&map, count, &applied);
+  if (applied != live)
+    fail ("Visited %zu pages, expected %zu.", applied, live);
+  msg ("Visited every page once.");
+
+  vamap_destroy (&map, NULL, NULL);
+}
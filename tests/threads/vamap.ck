@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(vamap) begin
+(vamap) Inserted 4096 pages, 2731 left after deletions.
+(vamap) Every lookup matched.
+(vamap) Visited every page once.
+(vamap) end
+EOF
+pass;
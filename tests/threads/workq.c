@@ -0,0 +1,63 @@
+/* Submits jobs to the kernel work queue, including jobs that
+   submit further jobs from a worker, and checks that every job runs
+   exactly once and signals its completion semaphore. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workq.h"
+
+#define JOB_CNT 16
+
+static struct work jobs[JOB_CNT], children[JOB_CNT];
+static int runs[JOB_CNT], child_runs[JOB_CNT];
+static struct semaphore done;
+
+static void
+child_job (void *aux) 
+{
+  child_runs[(int) (intptr_t) aux]++;
+}
+
+static void
+job (void *aux) 
+{
+  int i = (int) (intptr_t) aux;
+
+  runs[i]++;
+  if (i % 2 == 0) 
+    {
+      work_init (&children[i], child_job, aux, &done);
+      workq_submit (&children[i]);
+    }
+}
+
+void
+test_workq (void) 
+{
+  int i, expected = 0;
+
+  sema_init (&done, 0);
+  for (i = 0; i < JOB_CNT; i++) 
+    {
+      work_init (&jobs[i], job, (void *) (intptr_t) i, &done);
+      workq_submit (&jobs[i]);
+      expected += i % 2 == 0 ? 2 : 1;
+    }
+  msg ("Submitted %d jobs.", JOB_CNT);
+
+  for (i = 0; i < expected; i++)
+    sema_down (&done);
+  msg ("Waited for %d completions.", expected);
+
+  for (i = 0; i < JOB_CNT; i++) 
+    {
+      if (runs[i] != 1)
+        fail ("Job %d ran %d times.", i, runs[i]);
+      if (child_runs[i] != (i % 2 == 0 ? 1 : 0))
+        fail ("Child of job %d ran %d times.", i, child_runs[i]);
+    }
+  msg ("Every job ran exactly once.");
+}
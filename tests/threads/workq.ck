@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workq) begin
+(workq) Submitted 16 jobs.
+(workq) Waited for 24 completions.
+(workq) Every job ran exactly once.
+(workq) end
+EOF
+pass;
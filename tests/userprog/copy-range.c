@@ -0,0 +1,34 @@
+/* Copies "sample.txt" into a new file with copy_file_range() and
+   checks the copy and both file positions. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buffer[sizeof sample];
+  int in, out;
+
+  CHECK (create ("copy.txt", sizeof sample - 1), "create \"copy.txt\"");
+  CHECK ((in = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((out = open ("copy.txt")) > 1, "open \"copy.txt\"");
+
+  CHECK (copy_file_range (in, out, sizeof sample - 1) == sizeof sample - 1,
+         "copy_file_range whole file");
+  CHECK (tell (in) == sizeof sample - 1 && tell (out) == sizeof sample - 1,
+         "both positions advanced");
+  CHECK (copy_file_range (in, out, 10) == 0, "nothing left to copy");
+
+  memset (buffer, 0, sizeof buffer);
+  CHECK (pread (out, buffer, sizeof sample - 1, 0) == sizeof sample - 1,
+         "read back \"copy.txt\"");
+  CHECK (!strcmp (buffer, sample), "copy matches \"sample.txt\"");
+
+  seek (out, 0);
+  CHECK (copy_file_range (out, out, 10) == -1, "overlapping copy fails");
+  CHECK (copy_file_range (in, 0, 10) == -1, "copy to the console fails");
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(copy-range) begin
+(copy-range) create "copy.txt"
+(copy-range) open "sample.txt"
+(copy-range) open "copy.txt"
+(copy-range) copy_file_range whole file
+(copy-range) both positions advanced
+(copy-range) nothing left to copy
+(copy-range) read back "copy.txt"
+(copy-range) copy matches "sample.txt"
+(copy-range) overlapping copy fails
+(copy-range) copy to the console fails
+(copy-range) end
+copy-range: exit(0)
+EOF
+pass;
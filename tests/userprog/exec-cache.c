@@ -0,0 +1,36 @@
+/* Runs a copy of child-simple several times while rewriting its
+   ELF header in between, to check that a program is never started
+   from a stale copy of its headers. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char header[16], garbage[16];
+  int in, out, size;
+
+  CHECK ((in = open ("child-simple")) > 1, "open \"child-simple\"");
+  size = filesize (in);
+  CHECK (create ("cached", size), "create \"cached\"");
+  CHECK ((out = open ("cached")) > 1, "open \"cached\"");
+  CHECK (copy_file_range (in, out, size) == size, "copy into \"cached\"");
+
+  CHECK (wait (spawn ("cached", NULL, 0)) == 81, "run \"cached\"");
+  CHECK (wait (spawn ("cached", NULL, 0)) == 81, "run \"cached\" again");
+
+  CHECK (pread (out, header, sizeof header, 0) == sizeof header,
+         "read ELF header");
+  memset (garbage, 'x', sizeof garbage);
+  CHECK (pwrite (out, garbage, sizeof garbage, 0) == sizeof garbage,
+         "overwrite ELF header");
+  CHECK (spawn ("cached", NULL, 0) == PID_ERROR,
+         "run \"cached\" with a bad header");
+
+  CHECK (pwrite (out, header, sizeof header, 0) == sizeof header,
+         "restore ELF header");
+  CHECK (wait (spawn ("cached", NULL, 0)) == 81, "run restored \"cached\"");
+}
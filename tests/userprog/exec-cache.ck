@@ -0,0 +1,51 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(exec-cache) begin
+(exec-cache) open "child-simple"
+(exec-cache) create "cached"
+(exec-cache) open "cached"
+(exec-cache) copy into "cached"
+(child-simple) run
+cached: exit(81)
+(exec-cache) run "cached"
+(child-simple) run
+cached: exit(81)
+(exec-cache) run "cached" again
+(exec-cache) read ELF header
+(exec-cache) overwrite ELF header
+load: cached: error loading executable
+cached: exit(-1)
+(exec-cache) run "cached" with a bad header
+(exec-cache) restore ELF header
+(child-simple) run
+cached: exit(81)
+(exec-cache) run restored "cached"
+(exec-cache) end
+exec-cache: exit(0)
+EOF
+(exec-cache) begin
+(exec-cache) open "child-simple"
+(exec-cache) create "cached"
+(exec-cache) open "cached"
+(exec-cache) copy into "cached"
+(child-simple) run
+cached: exit(81)
+(exec-cache) run "cached"
+(child-simple) run
+cached: exit(81)
+(exec-cache) run "cached" again
+(exec-cache) read ELF header
+(exec-cache) overwrite ELF header
+cached: exit(-1)
+(exec-cache) run "cached" with a bad header
+(exec-cache) restore ELF header
+(child-simple) run
+cached: exit(81)
+(exec-cache) run restored "cached"
+(exec-cache) end
+exec-cache: exit(0)
+EOF
+pass;
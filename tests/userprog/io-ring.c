@@ -0,0 +1,73 @@
+/* Opens, writes, reads back and closes a file through one batch of
+   the I/O submission ring, and checks each completion. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ENTRIES 8
+
+static struct io_ring_sqe sqes[ENTRIES];
+static struct io_ring_cqe cqes[ENTRIES];
+static struct io_ring ring;
+
+static void
+queue (uint32_t op, int fd, void *buf, uint32_t len, int offset,
+       uint64_t user_data)
+{
+  struct io_ring_sqe *sqe = &sqes[ring.sq_tail++ % ENTRIES];
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = buf;
+  sqe->len = len;
+  sqe->offset = offset;
+  sqe->user_data = user_data;
+}
+
+static int64_t
+reap (uint64_t user_data)
+{
+  struct io_ring_cqe *cqe = &cqes[ring.cq_head++ % ENTRIES];
+  if (cqe->user_data != user_data)
+    fail ("completion %llu out of order", cqe->user_data);
+  return cqe->res;
+}
+
+void
+test_main (void) 
+{
+  static char data[] = "ring buffer";
+  char buffer[sizeof data];
+  int fd;
+
+  ring.entries = 3;
+  ring.sqes = sqes;
+  ring.cqes = cqes;
+  CHECK (io_ring_setup (&ring) == -1, "ring of 3 entries rejected");
+  ring.entries = ENTRIES;
+  CHECK (io_ring_setup (&ring) == 0, "set up ring of %d entries", ENTRIES);
+
+  CHECK (create ("ring.txt", sizeof data), "create \"ring.txt\"");
+  queue (IO_RING_OPEN, 0, "ring.txt", 0, -1, 1);
+  queue (IO_RING_NOP, 0, NULL, 0, -1, 2);
+  CHECK (io_ring_enter (ENTRIES) == 2, "run open and nop");
+  CHECK ((fd = reap (1)) > 1, "open \"ring.txt\"");
+  CHECK (reap (2) == 0, "nop");
+
+  memset (buffer, 0, sizeof buffer);
+  queue (IO_RING_WRITE, fd, data, sizeof data, -1, 3);
+  queue (IO_RING_READ, fd, buffer, sizeof buffer, 0, 4);
+  queue (IO_RING_READ, fd, (void *) 0xc0000000, 16, 0, 5);
+  queue (IO_RING_CLOSE, fd, NULL, 0, -1, 6);
+  CHECK (io_ring_enter (1) == 1, "run one request");
+  CHECK (io_ring_enter (ENTRIES) == 3, "run the rest");
+  CHECK (ring.sq_head == ring.sq_tail && ring.cq_tail == ring.sq_tail,
+         "rings drained");
+  CHECK (reap (3) == sizeof data, "write \"ring.txt\"");
+  CHECK (reap (4) == sizeof data, "read \"ring.txt\" at offset 0");
+  CHECK (!strcmp (buffer, data), "read back what was written");
+  CHECK (reap (5) == -1, "read into unmapped memory fails");
+  CHECK (reap (6) == 0, "close \"ring.txt\"");
+  CHECK (read (fd, buffer, 1) == -1, "descriptor is closed");
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(io-ring) begin
+(io-ring) ring of 3 entries rejected
+(io-ring) set up ring of 8 entries
+(io-ring) create "ring.txt"
+(io-ring) run open and nop
+(io-ring) open "ring.txt"
+(io-ring) nop
+(io-ring) run one request
+(io-ring) run the rest
+(io-ring) rings drained
+(io-ring) write "ring.txt"
+(io-ring) read "ring.txt" at offset 0
+(io-ring) read back what was written
+(io-ring) read into unmapped memory fails
+(io-ring) close "ring.txt"
+(io-ring) descriptor is closed
+(io-ring) end
+io-ring: exit(0)
+EOF
+pass;
@@ -0,0 +1,35 @@
+/* Opens the same file more times than the old fixed table of 128
+   descriptors could hold, and checks that the lowest free descriptor
+   is always the one handed out. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define OPEN_CNT 300
+
+static int handles[OPEN_CNT];
+
+void
+test_main (void) 
+{
+  int i;
+
+  for (i = 0; i < OPEN_CNT; i++)
+    {
+      handles[i] = open ("sample.txt");
+      if (handles[i] < 2)
+        fail ("open() #%d returned %d", i, handles[i]);
+      if (i > 0 && handles[i] != handles[i - 1] + 1)
+        fail ("open() #%d returned %d after %d", i, handles[i],
+              handles[i - 1]);
+    }
+  msg ("opened \"sample.txt\" %d times", OPEN_CNT);
+
+  close (handles[200]);
+  close (handles[10]);
+  CHECK (open ("sample.txt") == handles[10], "reopen gets lowest free fd");
+  CHECK (open ("sample.txt") == handles[200], "reopen gets next free fd");
+  CHECK (open ("sample.txt") == handles[OPEN_CNT - 1] + 1,
+         "then the table grows again");
+}
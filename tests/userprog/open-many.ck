@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-many) begin
+(open-many) opened "sample.txt" 300 times
+(open-many) reopen gets lowest free fd
+(open-many) reopen gets next free fd
+(open-many) then the table grows again
+(open-many) end
+open-many: exit(0)
+EOF
+pass;
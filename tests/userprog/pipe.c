@@ -0,0 +1,77 @@
+/* Streams data between processes through pipes: a writer that fills
+   the pipe several times over, a write with no reader left, and a
+   child whose standard output is a pipe. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Several times the pipe's capacity, so the writer has to block. */
+#define DATA_SIZE (3 * 4096 + 100)
+
+static char buf[DATA_SIZE];
+
+/* Reads FD into BUF until end of file and returns the byte count. */
+static int
+read_all (int fd, size_t size)
+{
+  int total = 0, n;
+
+  while ((n = read (fd, buf + total, size - total)) > 0)
+    total += n;
+  if (n < 0)
+    fail ("read returned %d", n);
+  return total;
+}
+
+void
+test_main (void) 
+{
+  const char *expected = "(child-simple) run\n";
+  int fds[2];
+  pid_t pid;
+  int i;
+
+  CHECK (pipe (fds) == 0, "pipe");
+  pid = fork ("writer");
+  if (pid == 0)
+    {
+      close (fds[0]);
+      for (i = 0; i < DATA_SIZE; i++)
+        buf[i] = i % 251;
+      exit (write (fds[1], buf, DATA_SIZE) == DATA_SIZE ? 0 : 1);
+    }
+  close (fds[1]);
+  CHECK (read_all (fds[0], sizeof buf) == DATA_SIZE,
+         "read %d bytes until end of file", DATA_SIZE);
+  for (i = 0; i < DATA_SIZE; i++)
+    if (buf[i] != (char) (i % 251))
+      fail ("byte %d is %d, not %d", i, buf[i], i % 251);
+  msg ("data arrived in order");
+  CHECK (wait (pid) == 0, "writer wrote everything");
+  close (fds[0]);
+
+  CHECK (pipe (fds) == 0, "pipe");
+  close (fds[0]);
+  CHECK (write (fds[1], "x", 1) == 0, "write with no reader");
+  close (fds[1]);
+
+  CHECK (pipe (fds) == 0, "pipe");
+  pid = fork ("redirect");
+  if (pid == 0)
+    {
+      if (dup2 (fds[1], STDOUT_FILENO) != STDOUT_FILENO)
+        exit (-1);
+      close (fds[0]);
+      close (fds[1]);
+      exec ("child-simple");
+    }
+  close (fds[1]);
+  memset (buf, 0, sizeof buf);
+  CHECK (read_all (fds[0], sizeof buf - 1) == (int) strlen (expected),
+         "read child's output");
+  CHECK (!strcmp (buf, expected), "output matches");
+  CHECK (wait (pid) == 81, "wait for child");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(pipe) begin
+(pipe) pipe
+(pipe) read 12388 bytes until end of file
+(pipe) data arrived in order
+(pipe) writer wrote everything
+(pipe) pipe
+(pipe) write with no reader
+(pipe) pipe
+(pipe) read child's output
+(pipe) output matches
+(pipe) wait for child
+(pipe) end
+EOF
+pass;
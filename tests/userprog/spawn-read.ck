@@ -0,0 +1,43 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(spawn-read) begin
+(spawn-read) open "sample.txt"
+(spawn-read) read "sample.txt" first 20 bytes
+(child-read) begin
+(child-read) open "sample.txt"
+(child-read) read "sample.txt" first 20 bytes
+(child-read) read "sample.txt" remainders
+(child-read) Child success
+(child-read) end
+child-read: exit(0)
+(spawn-read) spawn "child-read 2"
+(spawn-read) wait for child
+(spawn-read) Parent success
+load: no-such-file: open failed
+no-such-file: exit(-1)
+(spawn-read) spawn "no-such-file"
+(spawn-read) end
+spawn-read: exit(0)
+EOF
+(spawn-read) begin
+(spawn-read) open "sample.txt"
+(spawn-read) read "sample.txt" first 20 bytes
+(child-read) begin
+(child-read) open "sample.txt"
+(child-read) read "sample.txt" first 20 bytes
+(child-read) read "sample.txt" remainders
+(child-read) Child success
+(child-read) end
+child-read: exit(0)
+(spawn-read) spawn "child-read 2"
+(spawn-read) wait for child
+(spawn-read) Parent success
+no-such-file: exit(-1)
+(spawn-read) spawn "no-such-file"
+(spawn-read) end
+spawn-read: exit(0)
+EOF
+pass;
@@ -0,0 +1,56 @@
+/* Writes a file with writev(), reads parts of it back with pread()
+   and readv(), patches it with pwrite(), and checks that the
+   positional calls leave the file position alone. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static const char header[] = "HEAD";
+  static const char payload[] = "payload bytes";
+  char head_buf[sizeof header - 1];
+  char body_buf[sizeof payload - 1];
+  char buf[16];
+  struct iovec iov[2];
+  int fd;
+
+  CHECK (create ("vector.txt", 0), "create \"vector.txt\"");
+  CHECK ((fd = open ("vector.txt")) > 1, "open \"vector.txt\"");
+
+  iov[0].iov_base = (void *) header;
+  iov[0].iov_len = sizeof header - 1;
+  iov[1].iov_base = (void *) payload;
+  iov[1].iov_len = sizeof payload - 1;
+  CHECK (writev (fd, iov, 2) == sizeof header + sizeof payload - 2,
+         "writev header and payload");
+  CHECK (tell (fd) == sizeof header + sizeof payload - 2,
+         "position is past both buffers");
+
+  memset (buf, 0, sizeof buf);
+  CHECK (pread (fd, buf, 7, sizeof header - 1) == 7, "pread at offset");
+  CHECK (!memcmp (buf, "payload", 7), "pread got the payload");
+  CHECK (tell (fd) == sizeof header + sizeof payload - 2,
+         "pread left the position alone");
+
+  CHECK (pwrite (fd, "head", 4, 0) == 4, "pwrite at offset 0");
+  CHECK (tell (fd) == sizeof header + sizeof payload - 2,
+         "pwrite left the position alone");
+
+  seek (fd, 0);
+  iov[0].iov_base = head_buf;
+  iov[0].iov_len = sizeof head_buf;
+  iov[1].iov_base = body_buf;
+  iov[1].iov_len = sizeof body_buf;
+  CHECK (readv (fd, iov, 2) == sizeof head_buf + sizeof body_buf,
+         "readv header and payload");
+  CHECK (!memcmp (head_buf, "head", 4)
+         && !memcmp (body_buf, payload, sizeof body_buf),
+         "readv got both buffers");
+
+  CHECK (pread (fd, buf, 4, -1) == -1, "pread at negative offset fails");
+  close (fd);
+}
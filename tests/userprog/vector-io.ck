@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(vector-io) begin
+(vector-io) create "vector.txt"
+(vector-io) open "vector.txt"
+(vector-io) writev header and payload
+(vector-io) position is past both buffers
+(vector-io) pread at offset
+(vector-io) pread got the payload
+(vector-io) pread left the position alone
+(vector-io) pwrite at offset 0
+(vector-io) pwrite left the position alone
+(vector-io) readv header and payload
+(vector-io) readv got both buffers
+(vector-io) pread at negative offset fails
+(vector-io) end
+vector-io: exit(0)
+EOF
+pass;
@@ -0,0 +1,61 @@
+/* Reaps forked children with waitpid(): any child at a time, a
+   running child without blocking, and a specific child once it has
+   exited. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 3
+
+void
+test_main (void) 
+{
+  pid_t children[CHILD_CNT];
+  bool reaped[CHILD_CNT] = { false };
+  int status, i, j;
+  pid_t pid;
+
+  for (i = 0; i < CHILD_CNT; i++)
+    {
+      children[i] = fork ("child");
+      if (children[i] == 0)
+        exit (81 + i);
+      if (children[i] == PID_ERROR)
+        fail ("fork returned %d", children[i]);
+    }
+  msg ("forked %d children", CHILD_CNT);
+
+  for (i = 0; i < CHILD_CNT; i++)
+    {
+      pid = waitpid (WAIT_ANY, &status, 0);
+      for (j = 0; j < CHILD_CNT; j++)
+        if (children[j] == pid && !reaped[j])
+          break;
+      if (j == CHILD_CNT)
+        fail ("waitpid returned %d", pid);
+      if (status != 81 + j)
+        fail ("child %d exited with %d, not %d", pid, status, 81 + j);
+      reaped[j] = true;
+    }
+  msg ("reaped every child with WAIT_ANY");
+  CHECK (waitpid (WAIT_ANY, &status, 0) == -1, "no children left");
+  CHECK (waitpid (WAIT_ANY, &status, WNOHANG) == -1,
+         "no children left with WNOHANG");
+
+  pid = fork ("spinner");
+  if (pid == 0)
+    {
+      int fd;
+      while ((fd = open ("go")) < 0)
+        continue;
+      close (fd);
+      exit (7);
+    }
+  CHECK (waitpid (pid, &status, WNOHANG) == 0,
+         "running child not reaped with WNOHANG");
+  CHECK (create ("go", 0), "create \"go\"");
+  CHECK (waitpid (pid, &status, 0) == pid && status == 7,
+         "reaped child once it exited");
+  CHECK (wait (pid) == -1, "child cannot be reaped twice");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(waitpid) begin
+(waitpid) forked 3 children
+(waitpid) reaped every child with WAIT_ANY
+(waitpid) no children left
+(waitpid) no children left with WNOHANG
+(waitpid) running child not reaped with WNOHANG
+(waitpid) create "go"
+(waitpid) reaped child once it exited
+(waitpid) child cannot be reaped twice
+(waitpid) end
+EOF
+pass;
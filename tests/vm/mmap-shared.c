@@ -0,0 +1,58 @@
+/* Maps shared anonymous memory, lets several forked children write
+   their results into it, and checks that the parent sees every write,
+   including ones to pages it had never touched itself. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 4
+#define PAGE_SIZE 4096
+
+/* One page per child, after a page the parent writes first. */
+#define MAP_SIZE ((CHILD_CNT + 1) * PAGE_SIZE)
+
+void
+test_main (void)
+{
+  char *map = (char *) 0x10000000;
+  pid_t children[CHILD_CNT];
+  size_t i;
+  int c;
+
+  CHECK (mmap (map, MAP_SIZE, 1, MAP_SHARED_ANON, 0) == map,
+         "mmap shared anonymous memory");
+  for (i = 0; i < MAP_SIZE; i++)
+    if (map[i] != 0)
+      fail ("byte %zu is %d, not 0", i, map[i]);
+  msg ("memory starts out zeroed");
+  strlcpy (map, "from parent", PAGE_SIZE);
+
+  for (c = 0; c < CHILD_CNT; c++)
+    {
+      children[c] = fork ("child");
+      if (children[c] == 0)
+        {
+          char *page = map + (c + 1) * PAGE_SIZE;
+          if (strcmp (map, "from parent"))
+            exit (1);
+          memset (page, 'a' + c, PAGE_SIZE);
+          exit (0);
+        }
+    }
+  for (c = 0; c < CHILD_CNT; c++)
+    if (wait (children[c]) != 0)
+      fail ("child %d did not see the parent's write", c);
+  msg ("children saw the parent's write");
+
+  for (c = 0; c < CHILD_CNT; c++)
+    for (i = 0; i < PAGE_SIZE; i++)
+      if (map[(c + 1) * PAGE_SIZE + i] != 'a' + c)
+        fail ("byte %zu of child %d's page is wrong", i, c);
+  msg ("parent sees every child's write");
+
+  munmap (map);
+  CHECK (mmap (map, MAP_SIZE, 1, MAP_SHARED_ANON, 1) == MAP_FAILED,
+         "mmap with a nonzero offset fails");
+}
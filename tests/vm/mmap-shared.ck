@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-shared) begin
+(mmap-shared) mmap shared anonymous memory
+(mmap-shared) memory starts out zeroed
+(mmap-shared) children saw the parent's write
+(mmap-shared) parent sees every child's write
+(mmap-shared) mmap with a nonzero offset fails
+(mmap-shared) end
+EOF
+pass;
@@ -0,0 +1,52 @@
+/* Reads a file with read() into a buffer that the process has never
+   touched, straddling a page boundary, so that the kernel's write is
+   the first access to both pages.  Afterwards pages that were only
+   read, before and after the read() call, must still read as zero:
+   the write must not have gone to the shared zero page. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define OFFSET (PAGE_SIZE - 100)
+
+static char before[PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static char buf[3 * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static char after[PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+/* Returns true if the SIZE bytes at P are all zero. */
+static bool
+all_zero (const char *p, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		if (p[i] != 0)
+			return false;
+	return true;
+}
+
+void
+test_main (void)
+{
+	int handle;
+
+	CHECK (all_zero (before, sizeof before), "page read as zero");
+
+	CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+	CHECK (read (handle, buf + OFFSET, sizeof sample - 1) == sizeof sample - 1,
+			"read \"sample.txt\" into untouched pages");
+	CHECK (!memcmp (buf + OFFSET, sample, sizeof sample - 1),
+			"pages hold the file");
+	CHECK (all_zero (buf, OFFSET), "rest of first page is zero");
+	CHECK (all_zero (before, sizeof before),
+			"page read before still reads as zero");
+	CHECK (all_zero (after, sizeof after),
+			"page read after reads as zero");
+	CHECK (all_zero (buf + 2 * PAGE_SIZE, PAGE_SIZE),
+			"untouched page reads as zero");
+	close (handle);
+}
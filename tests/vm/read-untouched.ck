@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(read-untouched) begin
+(read-untouched) page read as zero
+(read-untouched) open "sample.txt"
+(read-untouched) read "sample.txt" into untouched pages
+(read-untouched) pages hold the file
+(read-untouched) rest of first page is zero
+(read-untouched) page read before still reads as zero
+(read-untouched) page read after reads as zero
+(read-untouched) untouched page reads as zero
+(read-untouched) end
+EOF
+pass;
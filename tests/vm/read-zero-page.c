@@ -0,0 +1,33 @@
+/* Reads a file with read() into a page that so far has only been
+   read, and so maps the shared zero page.  The kernel's write must
+   give the page a frame of its own and leave the zero page alone. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+static char buf[3 * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+void
+test_main (void)
+{
+	int handle;
+
+	CHECK (buf[0] == 0 && buf[PAGE_SIZE] == 0, "pages read as zero");
+	CHECK (get_phys_addr (&buf[0]) == get_phys_addr (&buf[PAGE_SIZE]),
+			"read pages share one frame");
+
+	CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+	CHECK (read (handle, buf, sizeof sample - 1) == sizeof sample - 1,
+			"read \"sample.txt\"");
+	CHECK (!memcmp (buf, sample, sizeof sample - 1), "page holds the file");
+	CHECK (get_phys_addr (&buf[0]) != get_phys_addr (&buf[PAGE_SIZE]),
+			"written page has its own frame");
+	CHECK (buf[PAGE_SIZE] == 0 && buf[2 * PAGE_SIZE] == 0,
+			"other pages still read as zero");
+	close (handle);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(read-zero-page) begin
+(read-zero-page) pages read as zero
+(read-zero-page) read pages share one frame
+(read-zero-page) open "sample.txt"
+(read-zero-page) read "sample.txt"
+(read-zero-page) page holds the file
+(read-zero-page) written page has its own frame
+(read-zero-page) other pages still read as zero
+(read-zero-page) end
+EOF
+pass;
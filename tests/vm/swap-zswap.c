@@ -0,0 +1,48 @@
+/* Checks that evicted anonymous pages that compress well are kept
+   in the compressed swap cache and come back intact.
+   Like swap-anon, this test relies on Pintos having less memory
+   than the chunk below. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1 << PAGE_SHIFT)
+#define ONE_MB (1 << 20) // 1MB
+#define CHUNK_SIZE (20*ONE_MB)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+static char big_chunks[CHUNK_SIZE];
+
+void
+test_main (void)
+{
+	long long stores, loads;
+	size_t i;
+	char *mem;
+
+	stores = get_vm_stat (VM_STAT_ZSWAP_STORES, false);
+	loads = get_vm_stat (VM_STAT_ZSWAP_LOADS, false);
+
+	for (i = 0 ; i < PAGE_COUNT ; i++) {
+		mem = big_chunks + i * PAGE_SIZE;
+		mem[0] = (char) i;
+		mem[PAGE_SIZE - 1] = (char) ~i;
+	}
+	msg ("wrote all pages");
+
+	for (i = 0 ; i < PAGE_COUNT ; i++) {
+		mem = big_chunks + i * PAGE_SIZE;
+		if (mem[0] != (char) i || mem[PAGE_SIZE - 1] != (char) ~i)
+			fail ("data is inconsistent in page %zu", i);
+	}
+	msg ("checked all pages");
+
+	CHECK (get_vm_stat (VM_STAT_ZSWAP_STORES, false) > stores,
+			"pages were evicted into the compressed cache");
+	CHECK (get_vm_stat (VM_STAT_ZSWAP_LOADS, false) > loads,
+			"pages were loaded back from the compressed cache");
+}
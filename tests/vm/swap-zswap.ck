@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-zswap) begin
+(swap-zswap) wrote all pages
+(swap-zswap) checked all pages
+(swap-zswap) pages were evicted into the compressed cache
+(swap-zswap) pages were loaded back from the compressed cache
+(swap-zswap) end
+EOF
+pass;
@@ -0,0 +1,36 @@
+/* Checks that page faults are counted by the VM statistics
+   readable through int 0x45. */
+
+#include <string.h>
+#include <syscall.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_PAGE_COUNT 4
+
+static char buf[CHUNK_PAGE_COUNT * PAGE_SIZE];
+
+void
+test_main (void)
+{
+	long long faults, minor;
+	size_t i;
+
+	faults = get_vm_stat (VM_STAT_FAULTS, false);
+	minor = get_vm_stat (VM_STAT_MINOR_FAULTS, false);
+
+	for (i = 0 ; i < CHUNK_PAGE_COUNT ; i++)
+		buf[i * PAGE_SIZE] = i;
+
+	CHECK (get_vm_stat (VM_STAT_FAULTS, false) - faults >= CHUNK_PAGE_COUNT,
+			"faults counted for untouched pages");
+	CHECK (get_vm_stat (VM_STAT_MINOR_FAULTS, false) - minor >= CHUNK_PAGE_COUNT,
+			"zero-filled pages are minor faults");
+	CHECK (get_vm_stat (VM_STAT_FAULTS, true)
+			>= get_vm_stat (VM_STAT_FAULTS, false),
+			"global count covers process count");
+	CHECK (get_vm_stat (VM_STAT_CNT, false) == -1, "unknown counter");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(vm-stat) begin
+(vm-stat) faults counted for untouched pages
+(vm-stat) zero-filled pages are minor faults
+(vm-stat) global count covers process count
+(vm-stat) unknown counter
+(vm-stat) end
+EOF
+pass;
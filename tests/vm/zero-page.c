@@ -0,0 +1,40 @@
+/* Checks that anonymous pages that are only read share one zero
+   frame, and that writing such a page gives it a frame of its own. */
+
+#include <string.h>
+#include <syscall.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_PAGE_COUNT 16
+
+static char buf[CHUNK_PAGE_COUNT * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+void
+test_main (void)
+{
+	long long zero_maps;
+	size_t i, j;
+
+	zero_maps = get_vm_stat (VM_STAT_ZERO_MAPS, false);
+	for (i = 0 ; i < CHUNK_PAGE_COUNT ; i++)
+		for (j = 0 ; j < PAGE_SIZE ; j++)
+			if (buf[i * PAGE_SIZE + j] != 0)
+				fail ("byte %zu of page %zu is not zero", j, i);
+	msg ("untouched pages read as zero");
+
+	CHECK (get_vm_stat (VM_STAT_ZERO_MAPS, false) - zero_maps
+			>= CHUNK_PAGE_COUNT, "reads mapped the zero page");
+	CHECK (get_phys_addr (&buf[0]) == get_phys_addr (&buf[PAGE_SIZE]),
+			"read pages share one frame");
+
+	buf[PAGE_SIZE] = 'a';
+	CHECK (get_phys_addr (&buf[0]) != get_phys_addr (&buf[PAGE_SIZE]),
+			"written page has its own frame");
+	CHECK (buf[PAGE_SIZE] == 'a', "written page holds the write");
+	CHECK (buf[0] == 0 && buf[2 * PAGE_SIZE] == 0,
+			"other pages still read as zero");
+}
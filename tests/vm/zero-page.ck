@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(zero-page) begin
+(zero-page) untouched pages read as zero
+(zero-page) reads mapped the zero page
+(zero-page) read pages share one frame
+(zero-page) written page has its own frame
+(zero-page) written page holds the write
+(zero-page) other pages still read as zero
+(zero-page) end
+EOF
+pass;
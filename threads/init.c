@@ -20,10 +20,14 @@
 #include "threads/mmu.h"
 #include "threads/palloc.h"
 #include "threads/pte.h"
+#include "threads/profile.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
+#include "threads/workq.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
+#include "userprog/exec-cache.h"
 #include "userprog/gdt.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
@@ -107,9 +111,14 @@ int main(void)
 #ifdef USERPROG
 	exception_init();
 	syscall_init();
+	exec_cache_init();
 #endif
+	trace_init();
+	profile_init();
+
 	/* Start thread scheduler and enable interrupts. */
 	thread_start();
+	workq_init();
 	serial_init_queue();
 	timer_calibrate();
 
@@ -241,6 +250,12 @@ parse_options(char **argv)
 			random_init(atoi(value));
 		else if (!strcmp(name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp(name, "-headless"))
+			vga_disable();
+		else if (!strcmp(name, "-trace"))
+			trace_enabled = true;
+		else if (!strcmp(name, "-profile"))
+			profile_enabled = true;
 #ifdef USERPROG
 		else if (!strcmp(name, "-ul"))
 			user_page_limit = atoi(value);
@@ -356,6 +371,9 @@ usage(void)
 		   "  -f                 Format file system disk during startup.\n"
 		   "  -rs=SEED           Set random number seed to SEED.\n"
 		   "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+		   "  -headless          Do not write console output to the screen.\n"
+		   "  -trace             Trace events and print them at power off.\n"
+		   "  -profile           Sample the running code on every timer tick.\n"
 #ifdef USERPROG
 		   "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -372,8 +390,11 @@ void power_off(void)
 #endif
 
 	print_stats();
+	trace_dump();
+	profile_dump();
 
 	printf("Powering off...\n");
+	serial_flush();
 	outw(0x604, 0x2000); /* Poweroff command for qemu */
 	for (;;)
 		;
@@ -385,6 +406,7 @@ print_stats(void)
 {
 	timer_print_stats();
 	thread_print_stats();
+	lock_print_stats();
 #ifdef FILESYS
 	disk_print_stats();
 #endif
@@ -393,4 +415,7 @@ print_stats(void)
 #ifdef USERPROG
 	exception_print_stats();
 #endif
+#ifdef VM
+	vm_print_stats();
+#endif
 }
@@ -0,0 +1,102 @@
+/* profile.c: Sampling profiler.
+ *
+ * With the -profile kernel option, every timer interrupt records
+ * the instruction it interrupted, kernel or user, in a histogram of
+ * PROFILE_SLOTS addresses kept in an open-addressing hash table.
+ * Samples run in the timer interrupt, so the table is allocated up
+ * front and never grows; a sample whose address finds no free slot
+ * is only counted as dropped.
+ *
+ * At power off profile_dump() prints the histogram, all numbers in
+ * hex:
+ *
+ *   profile: begin SAMPLES DROPPED
+ *   profile: k|u RIP COUNT
+ *   profile: end
+ *
+ * "k" marks kernel addresses and "u" user ones.  utils/pintos-profile
+ * resolves them to functions and prints a flat profile. */
+
+#include "threads/profile.h"
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Pages of histogram, and the addresses they hold. */
+#define PROFILE_PAGES 16
+#define PROFILE_SLOTS (PROFILE_PAGES * PGSIZE / sizeof (struct profile_slot))
+
+/* Slots probed before a sample is dropped. */
+#define PROFILE_PROBES 16
+
+struct profile_slot {
+	uint64_t rip;               /* Sampled address, 0 if free. */
+	uint64_t count;             /* Times it was sampled. */
+};
+
+/* Set by the -profile kernel option. */
+bool profile_enabled;
+
+static struct profile_slot *slots;
+static uint64_t sample_cnt;
+static uint64_t drop_cnt;
+
+/* Allocates the histogram.  Turns profiling off again if there is
+   no memory for it.  Must be called after the page allocator is set
+   up and before the timer starts ticking. */
+void
+profile_init (void) {
+	if (!profile_enabled)
+		return;
+	slots = palloc_get_multiple (PAL_ZERO, PROFILE_PAGES);
+	if (slots == NULL) {
+		printf ("profile: no memory for histogram, profiling disabled\n");
+		profile_enabled = false;
+	}
+}
+
+/* Records the instruction interrupted by timer interrupt F.  Runs
+   in the timer interrupt handler. */
+void
+profile_sample (const struct intr_frame *f) {
+	uint64_t rip = f->rip;
+	size_t i, h;
+
+	ASSERT (intr_context ());
+	if (!profile_enabled)
+		return;
+
+	sample_cnt++;
+	h = (rip * 0x9e3779b97f4a7c15ULL) >> 32;
+	for (i = 0; i < PROFILE_PROBES; i++) {
+		struct profile_slot *s = &slots[(h + i) % PROFILE_SLOTS];
+		if (s->rip == rip || s->rip == 0) {
+			s->rip = rip;
+			s->count++;
+			return;
+		}
+	}
+	drop_cnt++;
+}
+
+/* Prints the histogram. */
+void
+profile_dump (void) {
+	size_t i;
+
+	if (!profile_enabled)
+		return;
+
+	printf ("profile: begin %llx %llx\n",
+			(unsigned long long) sample_cnt, (unsigned long long) drop_cnt);
+	for (i = 0; i < PROFILE_SLOTS; i++)
+		if (slots[i].rip != 0)
+			printf ("profile: %c %llx %llx\n",
+					is_kernel_vaddr (slots[i].rip) ? 'k' : 'u',
+					(unsigned long long) slots[i].rip,
+					(unsigned long long) slots[i].count);
+	printf ("profile: end\n");
+}
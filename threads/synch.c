@@ -29,8 +29,13 @@
 #include "threads/synch.h"
 #include <stdio.h>
 #include <string.h>
+#include "devices/timer.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
+
+/* Locks reported by lock_print_stats(). */
+static struct list profiled_locks = LIST_INITIALIZER(profiled_locks);
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -46,7 +51,7 @@ void sema_init(struct semaphore *sema, unsigned value)
 	ASSERT(sema != NULL);
 
 	sema->value = value;
-	list_init(&sema->waiters);
+	waitq_init(&sema->waiters);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -67,7 +72,7 @@ void sema_down(struct semaphore *sema)
 	old_level = intr_disable();
 	while (sema->value == 0)
 	{ // while문이므로, sema value 0인 동안 대기
-		list_insert_ordered(&sema->waiters, &thread_current()->elem, better_priority, NULL);
+		waitq_push(&sema->waiters, &thread_current()->wait_elem, thread_current()->priority);
 		thread_block();
 	}
 	sema->value--;
@@ -110,10 +115,10 @@ void sema_up(struct semaphore *sema)
 	ASSERT(sema != NULL);
 	struct thread *next_thread;
 	old_level = intr_disable();
-	if (!list_empty(&sema->waiters))
+	if (!waitq_empty(&sema->waiters))
 	{
-		list_sort(&sema->waiters, better_priority, NULL);
-		next_thread = list_entry(list_pop_front(&sema->waiters), struct thread, elem);
+		// 대기열이 우선순위 힙이므로 정렬 없이 가장 높은 스레드를 꺼냄
+		next_thread = waitq_entry(waitq_pop(&sema->waiters), struct thread, wait_elem);
 		thread_unblock(next_thread);
 		// 이 위치에 새 코드를 넣었을 땐 터졌었음
 	}
@@ -184,6 +189,35 @@ void lock_init(struct lock *lock)
 
 	lock->holder = NULL;
 	sema_init(&lock->semaphore, 1);
+	lock->name = NULL;
+	lock->acquired_at = 0;
+	lock->acquire_cnt = lock->contended_cnt = 0;
+	lock->wait_ticks = lock->max_hold_ticks = 0;
+}
+
+/* Names LOCK and has lock_print_stats() report its contention
+   profile at shutdown.  LOCK must live until then, so this is meant
+   for the kernel's global locks. */
+void lock_profile(struct lock *lock, const char *name)
+{
+	enum intr_level old_level;
+
+	ASSERT(lock != NULL);
+	ASSERT(name != NULL);
+	ASSERT(lock->name == NULL);
+
+	lock->name = name;
+	old_level = intr_disable();
+	list_push_back(&profiled_locks, &lock->prof_elem);
+	intr_set_level(old_level);
+}
+
+/* Records that the current thread just took LOCK. */
+static void lock_taken(struct lock *lock)
+{
+	lock->holder = thread_current();
+	lock->acquired_at = timer_ticks();
+	lock->acquire_cnt++;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -201,6 +235,18 @@ void lock_acquire(struct lock *lock)
 	ASSERT(!lock_held_by_current_thread(lock));
 
 	struct thread *now_thread = thread_current();
+	int64_t start;
+
+	// 바로 얻을 수 있으면 경합이 아니다. 잠들어야 할 때만 경합으로 센다.
+	if (sema_try_down(&lock->semaphore))
+	{
+		lock_taken(lock);
+		return;
+	}
+
+	start = timer_ticks();
+	lock->contended_cnt++;
+	trace(TRACE_LOCK_WAIT, 0, (uint64_t) lock);
 	if (lock->holder)
 	{
 		now_thread->wait_on_lock = lock;
@@ -211,7 +257,9 @@ void lock_acquire(struct lock *lock)
 
 	sema_down(&lock->semaphore);
 	now_thread->wait_on_lock = NULL;
-	lock->holder = now_thread;
+	lock->wait_ticks += timer_elapsed(start);
+	trace(TRACE_LOCK_ACQUIRE, 0, (uint64_t) lock);
+	lock_taken(lock);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -229,7 +277,7 @@ bool lock_try_acquire(struct lock *lock)
 
 	success = sema_try_down(&lock->semaphore);
 	if (success)
-		lock->holder = thread_current();
+		lock_taken(lock);
 	return success;
 }
 
@@ -244,6 +292,10 @@ void lock_release(struct lock *lock)
 	ASSERT(lock != NULL);
 	ASSERT(lock_held_by_current_thread(lock));
 
+	int64_t held = timer_elapsed(lock->acquired_at);
+	if (held > lock->max_hold_ticks)
+		lock->max_hold_ticks = held;
+
 	remove_with_lock(lock);
 	refresh_priority();
 	lock->holder = NULL;
@@ -260,10 +312,27 @@ bool lock_held_by_current_thread(const struct lock *lock)
 	return lock->holder == thread_current();
 }
 
-/* One semaphore in a list. */
+/* Prints the contention profile of every lock given to
+   lock_profile(). */
+void lock_print_stats(void)
+{
+	struct list_elem *e;
+
+	for (e = list_begin(&profiled_locks); e != list_end(&profiled_locks);
+		 e = list_next(e))
+	{
+		struct lock *l = list_entry(e, struct lock, prof_elem);
+		printf("Lock %s: %lld acquisitions (%lld contended), "
+			   "%lld ticks waiting, %lld ticks max hold\n",
+			   l->name, l->acquire_cnt, l->contended_cnt,
+			   (long long) l->wait_ticks, (long long) l->max_hold_ticks);
+	}
+}
+
+/* One semaphore in a condition's wait queue. */
 struct semaphore_elem
 {
-	struct list_elem elem;		/* List element. */
+	struct waitq_elem elem;		/* Wait queue element. */
 	struct semaphore semaphore; /* This semaphore. */
 };
 
@@ -274,7 +343,7 @@ void cond_init(struct condition *cond)
 {
 	ASSERT(cond != NULL);
 
-	list_init(&cond->waiters);
+	waitq_init(&cond->waiters);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -300,31 +369,29 @@ void cond_init(struct condition *cond)
 void cond_wait(struct condition *cond, struct lock *lock)
 {
 	struct semaphore_elem waiter;
+	struct thread *t = thread_current();
+	enum intr_level old_level;
 
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
+	// waiter는 대기하는 스레드의 우선순위로 줄을 섬. 기부로 우선순위가
+	// 바뀌면 donate_priority()가 cond_elem을 통해 자리를 옮겨 줌
+	waiter.elem.queue = NULL;
 	sema_init(&waiter.semaphore, 0);
-	list_push_back(&cond->waiters, &waiter.elem);
+	old_level = intr_disable();
+	waitq_push(&cond->waiters, &waiter.elem, t->priority);
+	t->cond_elem = &waiter.elem;
+	intr_set_level(old_level);
+
 	lock_release(lock);
 	sema_down(&waiter.semaphore);
+	t->cond_elem = NULL;
 	lock_acquire(lock);
 }
 
-bool better_sema(const struct semaphore_elem *a, const struct semaphore_elem *b, void *aux UNUSED)
-{
-	return get_sema_prior(a) > get_sema_prior(b);
-}
-
-int get_sema_prior(const struct semaphore_elem *sema)
-{
-	if (list_empty(&sema->semaphore.waiters))
-		return 0;
-	return list_entry(list_front(&sema->semaphore.waiters), struct thread, elem)->priority;
-}
-
 /* If any threads are waiting on COND (protected by LOCK), then
    this function signals one of them to wake up from its wait.
    LOCK must be held before calling this function.
@@ -339,10 +406,16 @@ void cond_signal(struct condition *cond, struct lock *lock UNUSED)
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	if (!list_empty(&cond->waiters))
+	struct semaphore_elem *waiter = NULL;
+	enum intr_level old_level;
+
+	old_level = intr_disable();
+	if (!waitq_empty(&cond->waiters))
+		waiter = waitq_entry(waitq_pop(&cond->waiters), struct semaphore_elem, elem);
+	intr_set_level(old_level);
 
-		list_sort(&cond->waiters, better_sema, NULL);
-	sema_up(&list_entry(list_pop_front(&cond->waiters), struct semaphore_elem, elem)->semaphore);
+	if (waiter != NULL)
+		sema_up(&waiter->semaphore);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -356,6 +429,150 @@ void cond_broadcast(struct condition *cond, struct lock *lock)
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 
-	while (!list_empty(&cond->waiters))
+	while (!waitq_empty(&cond->waiters))
 		cond_signal(cond, lock);
 }
+
+/* Initializes RWLOCK.  A reader-writer lock can be held by any
+   number of readers at once, or by a single writer.
+
+   It prefers writers: once a writer is waiting, new readers wait
+   behind it, so a steady stream of readers cannot starve writers.
+   The flip side is that a reader must not acquire a reader-writer
+   lock it already holds, because a writer that arrived in between
+   would deadlock both.
+
+   The writer holds RWLOCK's inner lock for as long as it writes,
+   and every thread acquiring RWLOCK passes through that lock, so
+   threads waiting for a writer donate their priority to it the
+   same way lock_acquire() does.  A writer waiting for readers to
+   leave does not donate to them: there may be many, and they do
+   not hold a lock it could donate through. */
+void rwlock_init(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	lock_init(&rw->lock);
+	rw->readers = 0;
+	rw->writer_waiting = false;
+	sema_init(&rw->drained, 0);
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or is
+   waiting for it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void rwlock_acquire_read(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+
+	lock_acquire(&rw->lock);
+	old_level = intr_disable();
+	rw->readers++;
+	intr_set_level(old_level);
+	lock_release(&rw->lock);
+}
+
+/* Tries to acquire RW for reading and returns true if successful
+   or false if a writer holds it or is waiting for it.
+
+   This function will not sleep. */
+bool rwlock_try_acquire_read(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+
+	/* A writer, possibly the current thread, holds the inner lock for
+	   its whole critical section, and lock_try_acquire() must not be
+	   called on a lock the caller already holds. */
+	if (rw->lock.holder != NULL || !lock_try_acquire(&rw->lock))
+		return false;
+	old_level = intr_disable();
+	rw->readers++;
+	intr_set_level(old_level);
+	lock_release(&rw->lock);
+	return true;
+}
+
+/* Releases RW, which the current thread must hold for reading.
+   The last reader to leave wakes a waiting writer. */
+void rwlock_release_read(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+
+	old_level = intr_disable();
+	ASSERT(rw->readers > 0);
+	if (--rw->readers == 0 && rw->writer_waiting)
+	{
+		rw->writer_waiting = false;
+		sema_up(&rw->drained);
+	}
+	intr_set_level(old_level);
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds it.
+   New readers are held off from the moment the writer starts
+   waiting.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void rwlock_acquire_write(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+
+	lock_acquire(&rw->lock);
+	old_level = intr_disable();
+	while (rw->readers > 0)
+	{
+		rw->writer_waiting = true;
+		sema_down(&rw->drained);
+	}
+	intr_set_level(old_level);
+}
+
+/* Tries to acquire RW for writing and returns true if successful
+   or false if any other thread holds it.
+
+   This function will not sleep. */
+bool rwlock_try_acquire_write(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	if (rw->lock.holder != NULL || !lock_try_acquire(&rw->lock))
+		return false;
+	if (rw->readers > 0)
+	{
+		lock_release(&rw->lock);
+		return false;
+	}
+	return true;
+}
+
+/* Releases RW, which the current thread must hold for writing. */
+void rwlock_release_write(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+	ASSERT(rwlock_held_by_current_thread(rw));
+
+	lock_release(&rw->lock);
+}
+
+/* Returns true if the current thread holds RW for writing, false
+   otherwise.  There is no way to tell whether the current thread
+   holds it for reading. */
+bool rwlock_held_by_current_thread(const struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	return lock_held_by_current_thread(&rw->lock) && rw->readers == 0;
+}
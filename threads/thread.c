@@ -9,6 +9,7 @@
 #include "threads/intr-stubs.h"
 #include "threads/palloc.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
 #include "threads/vaddr.h"
 #include "intrinsic.h"
 #ifdef USERPROG
@@ -55,6 +56,9 @@ static unsigned thread_ticks; /* 마지막 양보 이후의 타이머 틱 수. *
 bool thread_mlfqs;
 
 static void kernel_thread(thread_func *, void *aux);
+static void set_priority(struct thread *, int priority);
+static tid_t create_thread(const char *name, int priority, thread_func *,
+						   void *aux, bool child);
 
 static void idle(void *aux UNUSED);
 static struct thread *next_thread_to_run(void);
@@ -111,6 +115,7 @@ void thread_init(void)
 	/* 전역 스레드 컨텍스트를 초기화합니다. */
 	// 스레드 식별자(TID)를 생성할 때 사용할 락을 초기화
 	lock_init(&tid_lock);
+	lock_profile(&tid_lock, "tid");
 	// 실행 준비가 된 스레드들을 저장할 준비 리스트를 초기화
 	list_init(&ready_list);
 	// 잠잘 준비가 된 스레드들을 저장할 수면 리스트를 초기화
@@ -201,6 +206,26 @@ void thread_print_stats(void)
    실제 우선 순위 스케줄링은 구현되지 않았습니다.
    우선 순위 스케줄링은 문제 1-3의 목표입니다. */
 tid_t thread_create(const char *name, int priority, thread_func *function, void *aux)
+{
+	return create_thread(name, priority, function, aux, false);
+}
+
+#ifdef USERPROG
+/* thread_create()와 같지만, 새 스레드를 현재 스레드의 자식 프로세스로 등록해
+   process_wait()로 종료 상태를 거둘 수 있게 합니다. 자식 기록은 새 스레드가
+   실행되기 전에 만들어지므로, 자식이 곧바로 종료해도 기록은 남습니다.
+   부모가 거두지 않는 커널 스레드는 thread_create()를 사용해야 합니다. */
+tid_t thread_create_child(const char *name, int priority, thread_func *function, void *aux)
+{
+	return create_thread(name, priority, function, aux, true);
+}
+#endif
+
+/* thread_create()와 thread_create_child()의 공통 부분.
+   CHILD이면 새 스레드의 자식 기록을 만듭니다. */
+static tid_t
+create_thread(const char *name, int priority, thread_func *function, void *aux,
+			  bool child UNUSED)
 {
 	struct thread *t;
 	tid_t tid;
@@ -219,6 +244,7 @@ tid_t thread_create(const char *name, int priority, thread_func *function, void
 	init_thread(t, name, priority);
 	// 새로 생성된 스레드 고유 id 할당
 	tid = t->tid = allocate_tid();
+	trace_attach(t);
 
 	/* 스케줄링될 경우 kernel_thread를 호출합니다.
 	 * 참고) rdi는 첫 번째 인자, rsi는 두 번째 인자입니다. */
@@ -236,15 +262,14 @@ tid_t thread_create(const char *name, int priority, thread_func *function, void
 	// 인터럽트를 활성화하는 플래그
 	t->tf.eflags = FLAG_IF;
 
-	// 현재 스레드의 자식으로 추가
-    list_push_back(&thread_current()->child_list, &t->child_elem);
-
-	/* 파일 디스크립터 테이블을 초기화해준다. */
-	t->fdt = palloc_get_multiple(PAL_ZERO, FDT_PAGES);
-    if (t->fdt == NULL) {
-		palloc_free_multiple(t->fdt, FDT_PAGES);
-        return TID_ERROR;
+#ifdef USERPROG
+	// 현재 스레드의 자식으로 추가한다. 종료 상태는 스레드보다 오래 남는 기록에 둔다.
+	if (child && !process_add_child(t))
+	{
+		palloc_free_page(t);
+		return TID_ERROR;
 	}
+#endif
 
 	/* 실행 큐에 추가합니다. */
 	// 스레드를 실행 준비 상태로 만든다.
@@ -564,14 +589,14 @@ init_thread(struct thread *t, const char *name, int priority)
 	t->init_priority = priority;
 	
 	list_init(&t->donations);	
-	list_init(&(t->child_list));
-	
-	sema_init(&t->load_sema, 0);
-	sema_init(&t->exit_sema, 0);
-    sema_init(&t->wait_sema, 0);
 
-	/* 다음 fd값을 2로 설정한다. */
-	t->next_fd = 2;
+#ifdef USERPROG
+	list_init(&t->child_list);
+	sema_init(&t->child_sema, 0);
+
+	/* 파일 디스크립터 테이블을 초기화해준다. 실제 메모리는 처음 파일을 열 때 할당된다. */
+	fdt_init(&t->fdt);
+#endif
 }
 
 /* 스케줄링될 다음 스레드를 선택하고 반환합니다.
@@ -727,6 +752,9 @@ schedule(void)
 
 	if (curr != next)
 	{
+		if (trace_enabled)
+			trace_thread(curr, TRACE_SWITCH, next->tid, curr->status);
+
 		/* 전환된 스레드가 죽어가는 경우, 그 struct thread를 파괴합니다.
 		   이 작업은 늦게 이루어져야 하며, thread_exit()에서 스레드가
 		   스스로 파괴되지 않도록 해야 합니다.
@@ -749,6 +777,7 @@ void donate_priority()
 	struct thread *now_thread = thread_current();
 	struct thread *holder;
 	int depth = 0;
+	enum intr_level old_level = intr_disable();
 	while (depth < 8 && now_thread->wait_on_lock != NULL)
 	{
 		holder = now_thread->wait_on_lock->holder;
@@ -756,12 +785,11 @@ void donate_priority()
 			break;
 		// 현재 스레드의 우선순위가 더 높다면 기부
 		if (holder->priority < now_thread->priority)
-		{
-			holder->priority = now_thread->priority;
-		}
+			set_priority(holder, now_thread->priority);
 		now_thread = holder;
 		depth++;
 	}
+	intr_set_level(old_level);
 }
 
 void remove_with_lock(struct lock *lock)
@@ -782,18 +810,36 @@ void refresh_priority()
 	struct thread *current_thread = thread_current();
 
 	// 1. 원래의 우선순위로 초기화
-	current_thread->priority = current_thread->init_priority;
+	int priority = current_thread->init_priority;
 
 	// 2. 기부받은 우선순위가 있는 경우 가장 높은 우선순위로 갱신
 	if (!list_empty(&current_thread->donations))
 	{
 		list_sort(&current_thread->donations, donate_high_priority, NULL);
 		struct thread *highest_donor = list_entry(list_front(&current_thread->donations), struct thread, donation_elem);
-		if (current_thread->priority < highest_donor->priority)
+		if (priority < highest_donor->priority)
 		{
-			current_thread->priority = highest_donor->priority;
+			priority = highest_donor->priority;
 		}
 	}
+	set_priority(current_thread, priority);
+}
+
+/* T의 우선순위를 PRIORITY로 바꿉니다. T가 세마포어나 조건 변수를 기다리는
+   중이면 대기열 안의 자리도 새 우선순위에 맞게 옮깁니다. 대기열은 넣을 때의
+   우선순위로 정렬되므로, 다른 스레드의 우선순위를 바꾸는 코드(기부, 그리고
+   구현된다면 MLFQS의 우선순위 재계산)는 반드시 이 함수를 거쳐야 합니다. */
+static void
+set_priority(struct thread *t, int priority)
+{
+	enum intr_level old_level = intr_disable();
+
+	t->priority = priority;
+	if (t->wait_elem.queue != NULL)
+		waitq_update(&t->wait_elem, priority);
+	if (t->cond_elem != NULL && t->cond_elem->queue != NULL)
+		waitq_update(t->cond_elem, priority);
+	intr_set_level(old_level);
 }
 
 /* 새 스레드에 사용할 tid를 반환합니다. */
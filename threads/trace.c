@@ -0,0 +1,163 @@
+/* trace.c: Per-thread event tracing.
+ *
+ * With the -trace kernel option, every thread gets a page of trace
+ * records: context switches, page faults, evictions, disk I/O and
+ * lock waits, each stamped with the TSC.  Records go into a ring, so
+ * a thread keeps its most recent TRACE_REC_CNT events.  Only code
+ * running on a thread's behalf writes its ring, and a slot is
+ * claimed with a single atomic add, so an interrupt handler that
+ * traces in the middle of another record cannot corrupt it and
+ * recording needs no lock.
+ *
+ * A ring outlives its thread, so that trace_dump() can print the
+ * events of every thread at shutdown.  To bound memory, at most
+ * TRACE_BUF_MAX rings are handed out; later threads go untraced.
+ *
+ * The dump goes to the console, one "trace:" line per record, all
+ * numbers in hex:
+ *
+ *   trace: begin TSC-PER-TICK
+ *   trace: thread TID NAME
+ *   trace: TSC TYPE ARG0 ARG1
+ *   trace: end
+ *
+ * utils/pintos-trace turns this into a timeline. */
+
+#include "threads/trace.h"
+#include <debug.h>
+#include <list.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* Most rings handed out. */
+#define TRACE_BUF_MAX 128
+
+/* One event. */
+struct trace_rec {
+	uint64_t tsc;               /* Time stamp counter. */
+	uint32_t type;              /* enum trace_type. */
+	uint32_t arg0;
+	uint64_t arg1;
+};
+
+/* Header of a ring page. */
+struct trace_hdr {
+	struct list_elem elem;      /* Element in all_bufs. */
+	tid_t tid;                  /* Owning thread. */
+	char name[16];              /* Its name. */
+	uint32_t next;              /* Records ever claimed. */
+};
+
+#define TRACE_REC_CNT \
+	((PGSIZE - sizeof (struct trace_hdr)) / sizeof (struct trace_rec))
+
+/* A thread's ring, one page. */
+struct trace_buf {
+	struct trace_hdr hdr;
+	struct trace_rec recs[TRACE_REC_CNT];
+};
+
+/* Set by the -trace kernel option. */
+bool trace_enabled;
+
+static struct list all_bufs = LIST_INITIALIZER (all_bufs);
+static size_t buf_cnt;
+
+/* Timer tick and TSC at trace_init(), to calibrate the TSC. */
+static int64_t start_ticks;
+static uint64_t start_tsc;
+
+/* Starts tracing, if enabled, and gives the running thread a ring.
+   Must be called after the page allocator is set up. */
+void
+trace_init (void) {
+	if (!trace_enabled)
+		return;
+	start_ticks = timer_ticks ();
+	start_tsc = rdtsc ();
+	trace_attach (thread_current ());
+}
+
+/* Gives T a ring to record into, if tracing is enabled and the
+   ring limit has not been reached. */
+void
+trace_attach (struct thread *t) {
+	struct trace_buf *b;
+	enum intr_level old_level;
+
+	if (!trace_enabled || buf_cnt >= TRACE_BUF_MAX)
+		return;
+	b = palloc_get_page (0);
+	if (b == NULL)
+		return;
+
+	b->hdr.tid = t->tid;
+	strlcpy (b->hdr.name, t->name, sizeof b->hdr.name);
+	b->hdr.next = 0;
+
+	old_level = intr_disable ();
+	list_push_back (&all_bufs, &b->hdr.elem);
+	buf_cnt++;
+	t->trace = b;
+	intr_set_level (old_level);
+}
+
+/* Records an event of TYPE in T's ring.  T must be the running
+   thread or one just switched away from. */
+void
+trace_thread (struct thread *t, enum trace_type type, uint32_t arg0,
+		uint64_t arg1) {
+	struct trace_buf *b = t->trace;
+	struct trace_rec *r;
+
+	if (b == NULL)
+		return;
+	r = &b->recs[__atomic_fetch_add (&b->hdr.next, 1, __ATOMIC_RELAXED)
+		% TRACE_REC_CNT];
+	r->type = type;
+	r->arg0 = arg0;
+	r->arg1 = arg1;
+	r->tsc = rdtsc ();
+}
+
+/* Records an event of TYPE in the running thread's ring. */
+void
+trace (enum trace_type type, uint32_t arg0, uint64_t arg1) {
+	if (trace_enabled)
+		trace_thread (thread_current (), type, arg0, arg1);
+}
+
+/* Prints every ring, oldest records first. */
+void
+trace_dump (void) {
+	struct list_elem *e;
+	int64_t ticks;
+
+	if (!trace_enabled)
+		return;
+
+	ticks = timer_elapsed (start_ticks);
+	printf ("trace: begin %llx\n", ticks > 0
+			? (unsigned long long) ((rdtsc () - start_tsc) / ticks) : 0ULL);
+	for (e = list_begin (&all_bufs); e != list_end (&all_bufs);
+			e = list_next (e)) {
+		struct trace_buf *b = list_entry (e, struct trace_buf, hdr.elem);
+		uint32_t next = b->hdr.next;
+		uint32_t i = next > TRACE_REC_CNT ? next - TRACE_REC_CNT : 0;
+
+		printf ("trace: thread %x %s\n", b->hdr.tid, b->hdr.name);
+		for (; i < next; i++) {
+			struct trace_rec *r = &b->recs[i % TRACE_REC_CNT];
+			printf ("trace: %llx %x %x %llx\n",
+					(unsigned long long) r->tsc, r->type, r->arg0,
+					(unsigned long long) r->arg1);
+		}
+	}
+	printf ("trace: end\n");
+}
@@ -0,0 +1,131 @@
+/* waitq.c: Priority-ordered queues of waiting threads.
+ *
+ * The queue is a pairing heap.  Every element points to its first child
+ * and to its next sibling, and PREV points back to the previous sibling
+ * or, for a first child, to the parent, so that an element can be cut
+ * out of the middle of the heap when its priority changes. */
+
+#include "threads/waitq.h"
+#include <debug.h>
+#include "threads/interrupt.h"
+
+/* Returns true if A should be woken before B. */
+static bool
+before (const struct waitq_elem *a, const struct waitq_elem *b) {
+	if (a->priority != b->priority)
+		return a->priority > b->priority;
+	return a->seq < b->seq;
+}
+
+/* Melds the heaps rooted at A and B and returns the new root.  The
+ * sibling links of A and B themselves are ignored. */
+static struct waitq_elem *
+meld (struct waitq_elem *a, struct waitq_elem *b) {
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+	if (before (b, a)) {
+		struct waitq_elem *t = a;
+		a = b;
+		b = t;
+	}
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+	a->next = a->prev = NULL;
+	return a;
+}
+
+/* Melds the sibling list starting at FIRST into one heap, pairing
+ * siblings left to right and then folding the pairs right to left. */
+static struct waitq_elem *
+merge_pairs (struct waitq_elem *first) {
+	struct waitq_elem *pairs = NULL, *root = NULL;
+
+	while (first != NULL) {
+		struct waitq_elem *a = first, *b = a->next;
+		first = b != NULL ? b->next : NULL;
+		struct waitq_elem *m = meld (a, b);
+		m->next = pairs;
+		pairs = m;
+	}
+	while (pairs != NULL) {
+		struct waitq_elem *p = pairs;
+		pairs = p->next;
+		root = meld (root, p);
+	}
+	return root;
+}
+
+void
+waitq_init (struct waitq *q) {
+	q->root = NULL;
+	q->next_seq = 0;
+}
+
+bool
+waitq_empty (const struct waitq *q) {
+	return q->root == NULL;
+}
+
+/* Queues E on Q with PRIORITY. */
+void
+waitq_push (struct waitq *q, struct waitq_elem *e, int priority) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (e->queue == NULL);
+
+	e->priority = priority;
+	e->seq = q->next_seq++;
+	e->queue = q;
+	e->child = NULL;
+	q->root = meld (q->root, e);
+}
+
+/* Removes and returns the waiter of Q with the highest priority, the
+ * earliest of them if several tie.  Q must not be empty. */
+struct waitq_elem *
+waitq_pop (struct waitq *q) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (!waitq_empty (q));
+
+	struct waitq_elem *e = q->root;
+	q->root = merge_pairs (e->child);
+	if (q->root != NULL)
+		q->root->prev = NULL;
+	e->queue = NULL;
+	return e;
+}
+
+/* Changes the priority of E, which is on a queue, to PRIORITY and
+ * moves it to match.  E keeps its place among waiters of its new
+ * priority as if it had arrived with it. */
+void
+waitq_update (struct waitq_elem *e, int priority) {
+	struct waitq *q = e->queue;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (q != NULL);
+
+	if (priority == e->priority)
+		return;
+
+	/* Cut E with its subtree out of the heap, then put its children
+	 * back and E on its own. */
+	if (e != q->root) {
+		if (e->prev->child == e)
+			e->prev->child = e->next;
+		else
+			e->prev->next = e->next;
+		if (e->next != NULL)
+			e->next->prev = e->prev;
+	}
+	struct waitq_elem *rest = e == q->root ? NULL : q->root;
+	rest = meld (rest, merge_pairs (e->child));
+
+	e->priority = priority;
+	e->child = NULL;
+	q->root = meld (rest, e);
+}
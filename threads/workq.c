@@ -0,0 +1,165 @@
+/* workq.c: Kernel work queue.
+ *
+ * Background work such as write-back or read-ahead is handed to a
+ * fixed pool of WORKQ_WORKERS kernel threads instead of creating a
+ * thread for each job.  Every worker owns a deque.  Work submitted by
+ * a worker goes on the front of its own deque and is taken from the
+ * front again, so work a job spawns runs next, while its data is
+ * still warm.  Work submitted from anywhere else is spread over the
+ * workers round-robin.  A worker whose deque is empty steals from the
+ * back of another's, the oldest work there.
+ *
+ * One counting semaphore counts the jobs queued over all deques, so
+ * a worker that gets past it is guaranteed to find one somewhere.
+ * The deques are only touched with interrupts off, which keeps
+ * workq_submit() usable from interrupt handlers.
+ *
+ * The workers are started by the first workq_submit(), so a kernel
+ * that never defers any work runs no extra threads.  That first call
+ * must come from a kernel thread, not an interrupt handler. */
+
+#include "threads/workq.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* Number of worker threads. */
+#define WORKQ_WORKERS 4
+
+struct worker {
+	struct thread *thread;      /* Worker thread, once it has started. */
+	struct list deque;          /* Queued work (struct work elem). */
+};
+
+static struct worker workers[WORKQ_WORKERS];
+static struct semaphore pending;    /* Number of queued jobs. */
+static unsigned next_worker;        /* Round-robin target for submits. */
+static bool started;                /* Worker threads created? */
+
+static thread_func worker_main;
+static void start_workers (void);
+
+/* Initializes the work queue.  The worker threads are only started
+   when work is first submitted. */
+void
+workq_init (void) {
+	int i;
+
+	sema_init (&pending, 0);
+	for (i = 0; i < WORKQ_WORKERS; i++)
+		list_init (&workers[i].deque);
+}
+
+/* Starts the worker threads. */
+static void
+start_workers (void) {
+	int i;
+
+	for (i = 0; i < WORKQ_WORKERS; i++) {
+		char name[16];
+		snprintf (name, sizeof name, "worker %d", i);
+		if (thread_create (name, PRI_DEFAULT, worker_main, &workers[i])
+				== TID_ERROR)
+			PANIC ("workq: cannot start %s", name);
+	}
+}
+
+/* Initializes W to call FUNC with AUX.  If DONE is non-null it is
+   upped once FUNC has returned. */
+void
+work_init (struct work *w, work_func *func, void *aux,
+		struct semaphore *done) {
+	ASSERT (w != NULL);
+	ASSERT (func != NULL);
+
+	w->func = func;
+	w->aux = aux;
+	w->done = done;
+}
+
+/* Returns the worker the current thread is, or NULL.  Interrupts
+   must be off. */
+static struct worker *
+current_worker (void) {
+	struct thread *t;
+	int i;
+
+	if (intr_context ())
+		return NULL;
+	t = thread_current ();
+	for (i = 0; i < WORKQ_WORKERS; i++)
+		if (workers[i].thread == t)
+			return &workers[i];
+	return NULL;
+}
+
+/* Queues W to run on a worker thread, starting the workers if this
+   is the first submission.  May be called from an interrupt handler
+   once the workers are running. */
+void
+workq_submit (struct work *w) {
+	enum intr_level old_level;
+	struct worker *self;
+	bool start;
+
+	ASSERT (w != NULL);
+
+	old_level = intr_disable ();
+	start = !started;
+	started = true;
+	ASSERT (!start || !intr_context ());
+	self = current_worker ();
+	if (self != NULL)
+		list_push_front (&self->deque, &w->elem);
+	else
+		list_push_back (&workers[next_worker++ % WORKQ_WORKERS].deque,
+				&w->elem);
+	intr_set_level (old_level);
+
+	/* The new workers find W through PENDING like any other job. */
+	if (start)
+		start_workers ();
+	sema_up (&pending);
+}
+
+/* Takes the next job for SELF: the newest of its own, or else the
+   oldest of the first other worker that has any.  Interrupts must be
+   off and a job must be queued. */
+static struct work *
+take_work (struct worker *self) {
+	int i;
+
+	if (!list_empty (&self->deque))
+		return list_entry (list_pop_front (&self->deque), struct work, elem);
+	for (i = 1; i < WORKQ_WORKERS; i++) {
+		struct worker *victim = &workers[(self - workers + i) % WORKQ_WORKERS];
+		if (!list_empty (&victim->deque))
+			return list_entry (list_pop_back (&victim->deque),
+					struct work, elem);
+	}
+	NOT_REACHED ();
+}
+
+/* Worker thread: runs queued work forever. */
+static void
+worker_main (void *self_) {
+	struct worker *self = self_;
+
+	self->thread = thread_current ();
+	for (;;) {
+		enum intr_level old_level;
+		struct work *w;
+
+		sema_down (&pending);
+		old_level = intr_disable ();
+		w = take_work (self);
+		intr_set_level (old_level);
+
+		/* W may be freed as soon as DONE is upped, so read it first. */
+		struct semaphore *done = w->done;
+		w->func (w->aux);
+		if (done != NULL)
+			sema_up (done);
+	}
+}
@@ -2,6 +2,7 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "userprog/uaccess.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "intrinsic.h"
@@ -12,6 +13,9 @@ static long long page_fault_cnt;
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
 
+/* Exception table, collected from section __ex_table by the linker. */
+extern const struct exception_entry __start_ex_table[], __stop_ex_table[];
+
 /* Registers handlers for interrupts that can be caused by user
    programs.
 
@@ -105,6 +109,19 @@ kill (struct intr_frame *f) {
 	}
 }
 
+/* Returns the fixup address for a fault at instruction RIP, or 0 if
+   RIP is not in the exception table.  The table is only a handful of
+   entries long, so a linear scan is enough. */
+static uintptr_t
+search_exception_table (uintptr_t rip) {
+	const struct exception_entry *e;
+
+	for (e = __start_ex_table; e < __stop_ex_table; e++)
+		if (e->insn == rip)
+			return e->fixup;
+	return 0;
+}
+
 /* Page fault handler.  This is a skeleton that must be filled in
    to implement virtual memory.  Some solutions to project 2 may
    also require modifying this code.
@@ -149,6 +166,16 @@ page_fault (struct intr_frame *f) {
 	/* Count page faults. */
 	page_fault_cnt++;
 
+	/* A user memory access routine touched memory that the process
+	   cannot access.  Let the routine fail instead of the process. */
+	if (!user) {
+		uintptr_t fixup = search_exception_table (f->rip);
+		if (fixup != 0) {
+			f->rip = fixup;
+			return;
+		}
+	}
+
 	/* If the fault is true fault, show info and exit. */
 	// printf ("Page fault at %p: %s error %s page in %s context.\n",
 	// 		fault_addr,
@@ -0,0 +1,180 @@
+/* exec-cache.c: Cache of parsed executable headers.
+ *
+ * Running a program used to re-read and re-validate its ELF header and
+ * every program header on each exec, all under filesys_lock.  The cache
+ * keeps the result of that work for the most recently loaded programs,
+ * keyed by inode, so that loading a program again only has to open it
+ * and can then map its segments right away.
+ *
+ * An entry holds its inode open, which keeps the in-memory inode and
+ * with it the inode's write generation alive.  Any write to the file
+ * bumps the generation, and an entry whose generation no longer matches
+ * is dropped on the next lookup.  Entries for files that have been
+ * removed are dropped by filesys_remove() through exec_cache_prune(),
+ * so that the cache does not keep their blocks allocated.
+ *
+ * Lookups and insertions happen with filesys_lock held.  An image may be
+ * used and released without it, so images are reference counted and
+ * the list is protected by a lock of its own. */
+
+#include "userprog/exec-cache.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "userprog/syscall.h"
+
+/* Number of images kept. */
+#define EXEC_CACHE_SIZE 16
+
+static struct list images;      /* Most recently used first. */
+static size_t image_cnt;
+static struct lock cache_lock;
+
+void
+exec_cache_init (void) {
+	list_init (&images);
+	lock_init (&cache_lock);
+	lock_profile (&cache_lock, "exec cache");
+}
+
+/* Frees IMAGE and closes its inode.  Closing an inode needs
+ * filesys_lock, which the caller may or may not hold. */
+static void
+image_free (struct exec_image *image) {
+	bool locked = lock_held_by_current_thread (&filesys_lock);
+
+	if (!locked)
+		lock_acquire (&filesys_lock);
+	inode_close (image->inode);
+	if (!locked)
+		lock_release (&filesys_lock);
+	free (image->segs);
+	free (image);
+}
+
+/* Drops a reference to IMAGE and returns it if that was the last one,
+ * so the caller can free it once CACHE_LOCK is released. */
+static struct exec_image *
+unref (struct exec_image *image) {
+	ASSERT (lock_held_by_current_thread (&cache_lock));
+	return --image->refs == 0 ? image : NULL;
+}
+
+/* Removes IMAGE from the cache.  Returns IMAGE if it should be freed. */
+static struct exec_image *
+evict (struct exec_image *image) {
+	list_remove (&image->elem);
+	image_cnt--;
+	return unref (image);
+}
+
+/* Returns true if IMAGE no longer describes its file. */
+static bool
+is_stale (const struct exec_image *image) {
+	return image->generation != inode_generation (image->inode)
+		|| inode_is_removed (image->inode);
+}
+
+/* Returns the cached image of the executable INODE with a reference
+ * for the caller, or NULL if there is none or it is out of date.  The
+ * caller holds filesys_lock. */
+struct exec_image *
+exec_cache_lookup (struct inode *inode) {
+	struct exec_image *found = NULL, *dead = NULL;
+	struct list_elem *e;
+
+	lock_acquire (&cache_lock);
+	for (e = list_begin (&images); e != list_end (&images); e = list_next (e)) {
+		struct exec_image *image = list_entry (e, struct exec_image, elem);
+		if (image->inode != inode)
+			continue;
+		if (is_stale (image))
+			dead = evict (image);
+		else {
+			found = image;
+			found->refs++;
+			list_remove (&found->elem);
+			list_push_front (&images, &found->elem);
+		}
+		break;
+	}
+	lock_release (&cache_lock);
+
+	if (dead != NULL)
+		image_free (dead);
+	return found;
+}
+
+/* Adds IMAGE, freshly parsed from INODE, to the cache and returns it
+ * with a reference for the caller.  IMAGE must have been allocated with
+ * malloc(), as must its segment array; the cache takes them over.  The
+ * caller holds filesys_lock. */
+struct exec_image *
+exec_cache_insert (struct inode *inode, struct exec_image *image) {
+	struct exec_image *dead[EXEC_CACHE_SIZE + 1];
+	size_t dead_cnt = 0;
+	struct list_elem *e;
+
+	image->inode = inode_reopen (inode);
+	image->generation = inode_generation (inode);
+	image->refs = 2;
+
+	lock_acquire (&cache_lock);
+	/* Drop entries that are out of date, then the least recently used
+	 * one if the cache is still full. */
+	for (e = list_begin (&images); e != list_end (&images); ) {
+		struct exec_image *old = list_entry (e, struct exec_image, elem);
+		e = list_next (e);
+		if ((old->inode == inode || is_stale (old))
+				&& (dead[dead_cnt] = evict (old)) != NULL)
+			dead_cnt++;
+	}
+	if (image_cnt == EXEC_CACHE_SIZE
+			&& (dead[dead_cnt] = evict (list_entry (list_back (&images),
+						struct exec_image, elem))) != NULL)
+		dead_cnt++;
+	list_push_front (&images, &image->elem);
+	image_cnt++;
+	lock_release (&cache_lock);
+
+	while (dead_cnt > 0)
+		image_free (dead[--dead_cnt]);
+	return image;
+}
+
+/* Drops every image whose file has been removed or written since it
+ * was parsed.  An image still in use by a loader is freed when that
+ * reference is released. */
+void
+exec_cache_prune (void) {
+	struct exec_image *dead[EXEC_CACHE_SIZE];
+	size_t dead_cnt = 0;
+	struct list_elem *e;
+
+	lock_acquire (&cache_lock);
+	for (e = list_begin (&images); e != list_end (&images); ) {
+		struct exec_image *image = list_entry (e, struct exec_image, elem);
+		e = list_next (e);
+		if (is_stale (image) && (dead[dead_cnt] = evict (image)) != NULL)
+			dead_cnt++;
+	}
+	lock_release (&cache_lock);
+
+	while (dead_cnt > 0)
+		image_free (dead[--dead_cnt]);
+}
+
+/* Releases a reference to IMAGE obtained from the cache.  Does nothing
+ * if IMAGE is null. */
+void
+exec_cache_put (struct exec_image *image) {
+	if (image == NULL)
+		return;
+
+	lock_acquire (&cache_lock);
+	image = unref (image);
+	lock_release (&cache_lock);
+
+	if (image != NULL)
+		image_free (image);
+}
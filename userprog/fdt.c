@@ -0,0 +1,173 @@
+/* fdt.c: File descriptor tables. */
+
+#include "userprog/fdt.h"
+#include <debug.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+
+/* Descriptors per word of the USED bitmap. */
+#define WORD_BITS 64
+
+/* Capacity of a table after its first open. */
+#define FDT_INIT_SIZE WORD_BITS
+
+_Static_assert (FDT_COUNT_LIMIT <= WORD_BITS * WORD_BITS,
+		"FULL needs a bit for every word of USED");
+
+/* Initializes T as an empty table.  Nothing is allocated until the first
+ * descriptor is opened, so kernel threads never pay for one. */
+void
+fdt_init (struct fd_table *t) {
+	t->files = NULL;
+	t->used = NULL;
+	t->full = 0;
+	t->size = 0;
+}
+
+/* Closes every descriptor in T and frees it. */
+void
+fdt_destroy (struct fd_table *t) {
+	for (int fd = fdt_next (t, -1); fd >= 0; fd = fdt_next (t, fd))
+		file_close (t->files[fd]);
+	free (t->files);
+	free (t->used);
+	fdt_init (t);
+}
+
+/* Makes T hold at least MIN_SIZE descriptors. */
+static bool
+grow (struct fd_table *t, int min_size) {
+	int size = t->size > 0 ? t->size : FDT_INIT_SIZE;
+	while (size < min_size)
+		size *= 2;
+	if (size > FDT_COUNT_LIMIT)
+		return false;
+	if (size == t->size)
+		return true;
+
+	struct file **files = calloc (size, sizeof *files);
+	uint64_t *used = calloc (size / WORD_BITS, sizeof *used);
+	if (files == NULL || used == NULL) {
+		free (files);
+		free (used);
+		return false;
+	}
+
+	if (t->size > 0) {
+		memcpy (files, t->files, t->size * sizeof *files);
+		memcpy (used, t->used, t->size / WORD_BITS * sizeof *used);
+		free (t->files);
+		free (t->used);
+	} else
+		used[0] = (1ULL << FDT_FIRST_FD) - 1;
+
+	t->files = files;
+	t->used = used;
+	t->size = size;
+	return true;
+}
+
+/* Puts FILE at free descriptor FD of T. */
+static void
+take (struct fd_table *t, int fd, struct file *file) {
+	int w = fd / WORD_BITS;
+
+	t->files[fd] = file;
+	t->used[w] |= 1ULL << (fd % WORD_BITS);
+	if (t->used[w] == UINT64_MAX)
+		t->full |= 1ULL << w;
+}
+
+/* Adds FILE to T at the lowest free descriptor and returns it, or returns
+ * -1 if T is full or cannot grow. */
+int
+fdt_add (struct fd_table *t, struct file *file) {
+	int w = t->full != UINT64_MAX ? __builtin_ctzll (~t->full) : WORD_BITS;
+
+	/* Every word we have is full, so the lowest free descriptor is the
+	 * first one of the next word. */
+	if (w >= t->size / WORD_BITS && !grow (t, (w + 1) * WORD_BITS))
+		return -1;
+
+	int fd = w * WORD_BITS + __builtin_ctzll (~t->used[w]);
+	take (t, fd, file);
+	return fd;
+}
+
+/* Puts FILE at descriptor FD of T.  Returns false if FD is out of range
+ * or already holds a file, or if T cannot grow.  FD may be one of the
+ * console descriptors, which FILE then replaces. */
+bool
+fdt_install (struct fd_table *t, int fd, struct file *file) {
+	if (fd < 0 || fd >= FDT_COUNT_LIMIT || !grow (t, fd + 1)
+			|| t->files[fd] != NULL)
+		return false;
+	take (t, fd, file);
+	return true;
+}
+
+/* Returns the file at descriptor FD of T, or NULL if FD is not open or
+ * is still the console. */
+struct file *
+fdt_get (const struct fd_table *t, int fd) {
+	if (fd < 0 || fd >= t->size)
+		return NULL;
+	return t->files[fd];
+}
+
+/* Frees descriptor FD of T and returns the file it held, or NULL if it
+ * was not open.  The file is not closed. */
+struct file *
+fdt_remove (struct fd_table *t, int fd) {
+	struct file *file = fdt_get (t, fd);
+	if (file != NULL) {
+		t->files[fd] = NULL;
+		/* A console descriptor goes back to being the console. */
+		if (fd >= FDT_FIRST_FD) {
+			t->used[fd / WORD_BITS] &= ~(1ULL << (fd % WORD_BITS));
+			t->full &= ~(1ULL << (fd / WORD_BITS));
+		}
+	}
+	return file;
+}
+
+/* Returns the lowest descriptor of T above FD that holds a file, or -1.
+ * Empty words are skipped whole, so walking a table costs one step per
+ * open file plus one per 64 descriptors of capacity. */
+int
+fdt_next (const struct fd_table *t, int fd) {
+	int n = fd + 1;
+
+	while (n < t->size) {
+		uint64_t bits = t->used[n / WORD_BITS] >> (n % WORD_BITS);
+		if (bits == 0) {
+			n = (n / WORD_BITS + 1) * WORD_BITS;
+			continue;
+		}
+		n += __builtin_ctzll (bits);
+		if (t->files[n] != NULL)
+			return n;
+		n++;                        /* A console descriptor. */
+	}
+	return -1;
+}
+
+/* Makes the empty table DST a copy of SRC, duplicating every open file. */
+bool
+fdt_duplicate (struct fd_table *dst, const struct fd_table *src) {
+	ASSERT (dst->size == 0);
+
+	if (src->size == 0)
+		return true;
+	if (!grow (dst, src->size))
+		return false;
+
+	for (int fd = fdt_next (src, -1); fd >= 0; fd = fdt_next (src, fd)) {
+		struct file *file = file_duplicate (src->files[fd]);
+		if (file == NULL)
+			return false;
+		take (dst, fd, file);
+	}
+	return true;
+}
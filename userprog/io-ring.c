@@ -0,0 +1,180 @@
+/* io-ring.c: Batched file I/O through rings shared with user space.
+ *
+ * A process registers one struct io_ring with io_ring_setup().  Each
+ * io_ring_enter() then runs up to the requested number of queued SQEs
+ * back to back, taking filesys_lock once for the whole batch instead of
+ * once per system call.
+ *
+ * The ring lives in user memory, where the process (or another process
+ * sharing the mapping) can change it at any time.  io_ring_enter()
+ * therefore copies the ring header into the kernel once and trusts only
+ * that copy's ENTRIES, SQES and CQES.  Every later access to the ring,
+ * like every access to request buffers and file names, goes through the
+ * uaccess routines: a bad request buffer fails its own request with
+ * result -1, and a bad ring ends the batch.  Either way the process
+ * cannot be killed while the batch holds filesys_lock. */
+
+#include "userprog/io-ring.h"
+#include <stdio.h>
+#include "filesys/directory.h"
+#include "filesys/file.h"
+#include "filesys/filesys.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#include "userprog/uaccess.h"
+#include "vm/vm.h"
+
+/* Returns true if the user range [ADDR, ADDR + SIZE) lies inside the
+ * process's regions, writable ones if TO_WRITE. */
+static bool
+user_range_ok (const void *addr, size_t size, bool to_write) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	const uint8_t *p = addr;
+
+	if (size == 0)
+		return true;
+	if (p == NULL || (uintptr_t) p + size < (uintptr_t) p
+			|| !is_user_vaddr (p + size - 1))
+		return false;
+
+	while (size > 0) {
+		struct vm_area *area = vma_find (spt, p);
+		if (area == NULL || (to_write && !area->writable))
+			return false;
+		size_t left = (uint8_t *) area->end - p;
+		if (left >= size)
+			break;
+		p += left;
+		size -= left;
+	}
+	return true;
+}
+
+/* Copies the header of user ring URING into RING and returns true if
+ * it and both of its queues are in writable user memory.  The kernel
+ * writes SQ_HEAD and CQ_TAIL and the CQEs, and only reads the SQEs, but
+ * those are filled in by the process anyway. */
+static bool
+ring_ok (const struct io_ring *uring, struct io_ring *ring) {
+	if (!user_range_ok (uring, sizeof *uring, true)
+			|| !copy_from_user (ring, uring, sizeof *ring))
+		return false;
+
+	uint32_t entries = ring->entries;
+	return entries > 0 && entries <= IO_RING_MAX_ENTRIES
+		&& (entries & (entries - 1)) == 0
+		&& user_range_ok (ring->sqes, entries * sizeof *ring->sqes, false)
+		&& user_range_ok (ring->cqes, entries * sizeof *ring->cqes, true);
+}
+
+/* Registers RING as the current process's ring, replacing any earlier
+ * one.  Returns 0, or -1 if RING is malformed. */
+int
+io_ring_setup (struct io_ring *ring) {
+	struct io_ring kring;
+
+	if (!ring_ok (ring, &kring))
+		return -1;
+	thread_current ()->io_ring = ring;
+	return 0;
+}
+
+/* Runs SQE, moving data through the kernel page BOUNCE.  The caller
+ * holds filesys_lock. */
+static int64_t
+run_sqe (const struct io_ring_sqe *sqe, void *bounce) {
+	struct file *file;
+	char name[NAME_MAX + 1];
+
+	switch (sqe->op) {
+		case IO_RING_NOP:
+			return 0;
+
+		case IO_RING_READ:
+		case IO_RING_WRITE: {
+			bool is_write = sqe->op == IO_RING_WRITE;
+			int console = is_write ? STDOUT_FILENO : STDIN_FILENO;
+
+			/* A pipe could wait on another process while the whole
+			 * batch holds filesys_lock, so pipes are left to read()
+			 * and write(). */
+			file = process_get_file (sqe->fd);
+			if (file == NULL ? sqe->fd != console || sqe->offset >= 0
+					: !needs_filesys_lock (file))
+				return -1;
+			return user_io (file, sqe->buf, sqe->len, sqe->offset,
+					is_write, bounce);
+		}
+
+		case IO_RING_OPEN: {
+			int len = strncpy_from_user (name, sqe->buf, sizeof name);
+			if (len < 0 || len > NAME_MAX
+					|| (file = filesys_open (name)) == NULL)
+				return -1;
+			int fd = process_add_file (file);
+			if (fd == -1)
+				file_close (file);
+			return fd;
+		}
+
+		case IO_RING_CLOSE:
+			process_close_file (sqe->fd);
+			return 0;
+
+		default:
+			return -1;
+	}
+}
+
+/* Runs up to TO_SUBMIT queued requests of the current process's ring,
+ * stopping early when the submission queue is empty or the completion
+ * queue is full.  Returns the number of requests run, or -1 if no
+ * valid ring is registered. */
+int
+io_ring_enter (unsigned to_submit) {
+	struct io_ring *uring = thread_current ()->io_ring;
+	struct io_ring ring;
+	unsigned done = 0;
+
+	/* The process may have unmapped or changed the ring since setup. */
+	if (uring == NULL || !ring_ok (uring, &ring))
+		return -1;
+
+	void *bounce = palloc_get_page (0);
+	if (bounce == NULL)
+		return -1;
+
+	uint32_t mask = ring.entries - 1;
+	uint32_t sq_head = ring.sq_head, cq_tail = ring.cq_tail;
+	lock_acquire (&filesys_lock);
+	while (done < to_submit) {
+		uint32_t sq_tail, cq_head;
+		struct io_ring_sqe sqe;
+		struct io_ring_cqe cqe;
+
+		if (!copy_from_user (&sq_tail, &uring->sq_tail, sizeof sq_tail)
+				|| !copy_from_user (&cq_head, &uring->cq_head, sizeof cq_head)
+				|| sq_head == sq_tail || cq_tail - cq_head >= ring.entries
+				|| !copy_from_user (&sqe, &ring.sqes[sq_head & mask],
+					sizeof sqe))
+			break;
+		sq_head++;
+
+		cqe.user_data = sqe.user_data;
+		cqe.res = run_sqe (&sqe, bounce);
+		if (!copy_to_user (&ring.cqes[cq_tail & mask], &cqe, sizeof cqe))
+			break;
+		cq_tail++;
+		done++;
+	}
+	/* Publish the new indexes.  If the ring has gone bad, the process
+	 * simply does not see them. */
+	copy_to_user (&uring->sq_head, &sq_head, sizeof sq_head);
+	copy_to_user (&uring->cq_tail, &cq_tail, sizeof cq_tail);
+	lock_release (&filesys_lock);
+	palloc_free_page (bounce);
+	return done;
+}
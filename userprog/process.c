@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "userprog/exec-cache.h"
 #include "userprog/gdt.h"
 #include "userprog/tss.h"
 #include "filesys/directory.h"
@@ -13,6 +14,7 @@
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
@@ -24,14 +26,16 @@
 
 #ifdef VM
 #include "vm/vm.h"
-#include "threads/malloc.h"
 #endif
 
 static void process_cleanup(void);
 static bool load(const char *file_name, struct intr_frame *if_);
 static void initd(void *f_name);
 static void __do_fork(void *);
-struct thread *get_child_process(int pid);
+static void __do_spawn(void *);
+static bool process_load(char *cmd_line, struct intr_frame *if_);
+static struct child_record *get_child_record(tid_t tid);
+static void put_child_record(struct child_record *rec);
 
 /* initd와 다른 프로세스를 위한 일반적인 프로세스 초기화 함수 */
 static void
@@ -63,7 +67,7 @@ tid_t process_create_initd(const char *file_name)
     // ~ Argument Passing
 
     /* Create a new thread to execute FILE_NAME. */
-    tid = thread_create(file_name, PRI_DEFAULT, initd, fn_copy);
+    tid = thread_create_child(file_name, PRI_DEFAULT, initd, fn_copy);
     if (tid == TID_ERROR)
         palloc_free_page(fn_copy);
     return tid;
@@ -73,7 +77,8 @@ static void
 initd(void *f_name)
 {
 #ifdef VM
-	supplemental_page_table_init(&thread_current()->spt);
+	if (!supplemental_page_table_init(&thread_current()->spt))
+		PANIC("Fail to launch initd\n");
 #endif
 
 	process_init();
@@ -92,12 +97,13 @@ tid_t process_fork(const char *name, struct intr_frame *if_ UNUSED)
     memcpy(&cur->parent_if, if_, sizeof(struct intr_frame));
 
     // 현재 스레드를 fork한 new 스레드를 생성한다.
-    tid_t pid = thread_create(name, PRI_DEFAULT, __do_fork, cur);
+    tid_t pid = thread_create_child(name, PRI_DEFAULT, __do_fork, cur);
     if (pid == TID_ERROR)
         return TID_ERROR;
 
-    // 자식이 로드될 때까지 대기하기 위해서 방금 생성한 자식 스레드를 찾는다.
-    struct thread *child = get_child_process(pid);
+    // 자식이 로드될 때까지 대기하기 위해서 방금 생성한 자식의 기록을 찾는다.
+    // 자식 스레드는 곧 사라질 수 있지만 기록은 부모가 거둘 때까지 남는다.
+    struct child_record *child = get_child_record(pid);
 
     // 현재 스레드는 생성만 완료된 상태이다. 생성되어서 ready_list에 들어가고 실행될 때 __do_fork 함수가 실행된다.
     // __do_fork 함수가 실행되어 로드가 완료될 때까지 부모는 대기한다.
@@ -106,23 +112,149 @@ tid_t process_fork(const char *name, struct intr_frame *if_ UNUSED)
     // 자식 프로세스의 pid를 반환한다.
     return pid;
 }
-// tid는 단순히 스레드의 ID일 뿐이고,
-// 실제로 해당 스레드의 데이터(예: 세마포어,
-// 스택 프레임 등)에 접근하려면 그 스레드의 구조체 포인터가 필요합니다.
-// 그래서 get_child_process()를 통해 자식 스레드의 구조체를 찾는 과정
-struct thread *get_child_process(int pid)
+// 새 스레드 CHILD의 종료 기록을 만들어 현재 스레드의 자식으로 등록한다.
+// thread_create_child()가 CHILD를 실행 큐에 넣기 전에 호출한다. 메모리가 없으면 false를 반환한다.
+bool process_add_child(struct thread *child)
 {
-	struct thread *cur = thread_current();
-	struct list *child_list = &cur->child_list;
+	struct child_record *rec = malloc(sizeof *rec);
+	if (rec == NULL)
+		return false;
+
+	rec->tid = child->tid;
+	rec->exit_status = 0;
+	rec->exited = false;
+	rec->refs = 2;
+	rec->parent = thread_current();
+	sema_init(&rec->load_sema, 0);
+	child->record = rec;
+
+	enum intr_level old_level = intr_disable();
+	list_push_back(&rec->parent->child_list, &rec->elem);
+	intr_set_level(old_level);
+	return true;
+}
+
+// 현재 스레드의 자식 중 TID인 자식의 기록을 찾는다. 없으면 NULL을 반환한다.
+// 기록은 현재 스레드만 목록에서 빼므로, 찾은 기록은 거둘 때까지 유효하다.
+static struct child_record *get_child_record(tid_t tid)
+{
+	struct list *child_list = &thread_current()->child_list;
+	struct child_record *found = NULL;
+
+	enum intr_level old_level = intr_disable();
 	for (struct list_elem *e = list_begin(child_list); e != list_end(child_list); e = list_next(e))
 	{
-		struct thread *t = list_entry(e, struct thread, child_elem);
-		if (t->tid == pid)
+		struct child_record *rec = list_entry(e, struct child_record, elem);
+		if (rec->tid == tid)
 		{
-			return t;
+			found = rec;
+			break;
 		}
 	}
-	return NULL;
+	intr_set_level(old_level);
+	return found;
+}
+
+// REC에 대한 참조 하나를 놓는다. 부모와 자식이 모두 놓으면 해제한다.
+// 인터럽트를 끈 채로 호출한다.
+static void put_child_record(struct child_record *rec)
+{
+	ASSERT(intr_get_level() == INTR_OFF);
+	if (--rec->refs == 0)
+		free(rec);
+}
+
+/* process_spawn()이 새 자식에게 넘겨주는 인자. 부모는 자식이 로드를 마칠
+ * 때까지 기다리므로 부모의 스택에 둡니다. */
+struct spawn_info
+{
+    struct thread *parent;
+    char *cmd_line;    /* 명령줄이 담긴 페이지. 자식이 해제한다. */
+    const int *fds;    /* 자식에게 물려줄 fd 목록. */
+    size_t fd_cnt;
+    bool success;      /* 자식이 로드에 성공했는지. */
+};
+
+/* CMD_LINE을 실행하는 자식 프로세스를 바로 만듭니다. fork와 달리 부모의
+ * 주소 공간은 복사하지 않고, FDS에 나열된 FD_CNT개의 파일만 같은 번호로
+ * 물려줍니다. CMD_LINE은 palloc으로 할당된 페이지여야 하며 이 함수가
+ * 소유권을 가져갑니다. 자식의 pid를 반환하고, 로드에 실패하면 TID_ERROR를
+ * 반환합니다. */
+tid_t process_spawn(char *cmd_line, const int *fds, size_t fd_cnt)
+{
+    struct spawn_info info = {
+        .parent = thread_current(),
+        .cmd_line = cmd_line,
+        .fds = fds,
+        .fd_cnt = fd_cnt,
+        .success = false,
+    };
+
+    // 스레드 이름은 명령줄의 첫 단어(프로그램 이름)로 한다.
+    char name[16];
+    strlcpy(name, cmd_line, sizeof name);
+    name[strcspn(name, " ")] = '\0';
+
+    tid_t pid = thread_create_child(name, PRI_DEFAULT, __do_spawn, &info);
+    if (pid == TID_ERROR)
+    {
+        palloc_free_page(cmd_line);
+        return TID_ERROR;
+    }
+
+    // 자식이 로드를 마칠 때까지 대기한다.
+    struct child_record *child = get_child_record(pid);
+    sema_down(&child->load_sema);
+
+    // 로드에 실패한 자식은 바로 종료되므로 여기서 거둔다.
+    if (!info.success)
+    {
+        process_wait(pid);
+        return TID_ERROR;
+    }
+    return pid;
+}
+
+/* process_spawn()으로 만든 자식이 실행하는 스레드 함수 */
+static void
+__do_spawn(void *aux)
+{
+    struct spawn_info *info = aux;
+    struct thread *parent = info->parent;
+    struct thread *current = thread_current();
+    struct intr_frame if_;
+    bool success = true;
+
+#ifdef VM
+    success = supplemental_page_table_init(&current->spt);
+#endif
+
+    // 부모가 나열한 fd만 같은 번호로 복제한다.
+    for (size_t i = 0; i < info->fd_cnt && success; i++)
+    {
+        int fd = info->fds[i];
+        struct file *file = fdt_get(&parent->fdt, fd);
+        if (file == NULL || fdt_get(&current->fdt, fd) != NULL)
+            continue;
+        file = file_duplicate(file);
+        success = file != NULL && fdt_install(&current->fdt, fd, file);
+        if (!success)
+            file_close(file);
+    }
+
+    if (success)
+        success = process_load(info->cmd_line, &if_);
+    else
+        palloc_free_page(info->cmd_line);
+
+    // 로드 결과를 알리고 부모 대기를 해제한다. 이후로 INFO는 사용할 수 없다.
+    info->success = success;
+    sema_up(&current->record->load_sema);
+
+    if (!success)
+        exit(-1);
+    do_iret(&if_);
+    NOT_REACHED();
 }
 
 #ifndef VM
@@ -192,8 +324,8 @@ __do_fork(void *aux)
 
     process_activate(current);
 #ifdef VM
-    supplemental_page_table_init(&current->spt);
-    if (!supplemental_page_table_copy(&current->spt, &parent->spt))
+    if (!supplemental_page_table_init(&current->spt)
+        || !supplemental_page_table_copy(&current->spt, &parent->spt))
         goto error;
 #else
     if (!pml4_for_each(parent->pml4, duplicate_pte, parent))
@@ -206,46 +338,38 @@ __do_fork(void *aux)
      * TODO:       from the fork() until this function successfully duplicates
      * TODO:       the resources of parent.*/
 
-    // FDT 복사
-    for (int i = 0; i < FDT_COUNT_LIMIT; i++)
-    {
-        struct file *file = parent->fdt[i];
-        if (file == NULL)
-            continue;
-        if (file > 2)
-            file = file_duplicate(file);
-        current->fdt[i] = file;
-    }
-    current->next_fd = parent->next_fd;
+    // FDT 복사: 열려 있는 fd만 돌면서 복제한다.
+    if (!fdt_duplicate(&current->fdt, &parent->fdt))
+        goto error;
+    // 주소 공간이 그대로 복사되었으므로 등록된 링도 그대로 쓸 수 있다.
+    current->io_ring = parent->io_ring;
 
     // 로드가 완료될 때까지 기다리고 있던 부모 대기 해제
-    sema_up(&current->load_sema);
+    sema_up(&current->record->load_sema);
     process_init();
 
     /* Finally, switch to the newly created process. */
     if (succ)
         do_iret(&if_);
 error:
-    sema_up(&current->load_sema);
+    sema_up(&current->record->load_sema);
     exit(TID_ERROR);
 }
-/* f_name으로 현재 실행 컨텍스트를 전환합니다.
- * 실패 시 -1을 반환합니다. */
-int process_exec(void *f_name)
-{ // 인자: 실행하려는 이진 파일의 이름
-    char *file_name = f_name;
+/* CMD_LINE의 프로그램을 현재 주소 공간에 로드하고, 진입할 수 있도록 IF_를
+ * 채웁니다.  CMD_LINE 페이지는 여기서 해제됩니다.  실패 시 false를 반환합니다. */
+static bool
+process_load(char *cmd_line, struct intr_frame *if_)
+{
+    char *file_name = cmd_line;
     bool success;
 
-    /* We cannot use the intr_frame in the thread structure.
-     * This is because when current thread rescheduled,
-     * it stores the execution information to the member. */
-    struct intr_frame _if;
-    _if.ds = _if.es = _if.ss = SEL_UDSEG;
-    _if.cs = SEL_UCSEG;
-    _if.eflags = FLAG_IF | FLAG_MBS;
+    if_->ds = if_->es = if_->ss = SEL_UDSEG;
+    if_->cs = SEL_UCSEG;
+    if_->eflags = FLAG_IF | FLAG_MBS;
 
     /* We first kill the current context */
     process_cleanup();
+    thread_current()->io_ring = NULL; // 링은 이전 주소 공간에 있었다.
 	//supplemental_page_table_init(&thread_current()->spt); // cleanup 할때 사라지는거 같아서 일단 추가해봄 @@@
 
     // Argument Passing ~
@@ -257,25 +381,38 @@ int process_exec(void *f_name)
     // ~ Argument Passing
 
     /* And then load the binary */
-	lock_acquire(&filesys_lock);
-    success = load(file_name, &_if);
-	lock_release(&filesys_lock);
+    success = load(file_name, if_);
     // 이진 파일을 디스크에서 메모리로 로드한다.
     // 로드된 후 실행할 메인 함수의 시작 주소 필드 초기화 (if_.rip)
     // user stack의 top 포인터 초기화 (if_.rsp)
     // 위 과정을 성공하면 실행을 계속하고, 실패하면 스레드가 종료된다.
 
     // Argument Passing ~
-    argument_stack(parse, count, &_if.rsp); // 함수 내부에서 parse와 rsp의 값을 직접 변경하기 위해 주소 전달
-    _if.R.rdi = count;
-    _if.R.rsi = (char *)_if.rsp + 8;
+    if (success)
+    {
+        argument_stack(parse, count, &if_->rsp); // 함수 내부에서 parse와 rsp의 값을 직접 변경하기 위해 주소 전달
+        if_->R.rdi = count;
+        if_->R.rsi = (char *)if_->rsp + 8;
+    }
 
     // hex_dump(_if.rsp, _if.rsp, USER_STACK - (uint64_t)_if.rsp, true); // user stack을 16진수로 프린트
     // ~ Argument Passing
 
-    /* If load failed, quit. */
     palloc_free_page(file_name);
-    if (!success)
+    return success;
+}
+
+/* f_name으로 현재 실행 컨텍스트를 전환합니다.
+ * 실패 시 -1을 반환합니다. */
+int process_exec(void *f_name)
+{ // 인자: 실행하려는 이진 파일의 이름
+    /* We cannot use the intr_frame in the thread structure.
+     * This is because when current thread rescheduled,
+     * it stores the execution information to the member. */
+    struct intr_frame _if;
+
+    /* If load failed, quit. */
+    if (!process_load(f_name, &_if))
         return -1;
 
     /* Start switched process. */
@@ -334,15 +471,64 @@ int process_wait(tid_t child_tid UNUSED)
 {
 	/* XXX: 힌트) Pintos가 process_wait(initd)일 때 종료됩니다.
 	 * XXX: process_wait을 구현하기 전에 여기에 무한 루프를 추가하는 것을 추천합니다. */
-	struct thread *child = get_child_process(child_tid);
-	if (child == NULL)
+	int status;
+	if (child_tid <= 0 || process_waitpid(child_tid, &status, false) != child_tid)
 		return -1;
+	return status;
+}
+
+/* 자식 TID를 거두고 그 종료 상태를 *STATUS에 저장한 뒤 TID를 반환합니다.
+ * TID가 -1이면 아무 자식이나 거둡니다.  해당하는 자식이 없으면 -1을
+ * 반환합니다.  자식이 아직 실행 중이면 종료할 때까지 기다리는데, NOHANG이면
+ * 기다리지 않고 0을 반환합니다.
+ *
+ * 종료한 자식의 기록은 child_list의 앞쪽에 모이므로, 아무 자식이나 거둘
+ * 때는 자식이 몇 명이든 맨 앞만 보면 됩니다. */
+tid_t process_waitpid(tid_t tid, int *status, bool nohang)
+{
+	struct thread *cur = thread_current();
+	struct child_record *rec;
+	tid_t result;
+
+	enum intr_level old_level = intr_disable();
+	for (;;)
+	{
+		if (tid == -1)
+		{
+			rec = list_empty(&cur->child_list) ? NULL
+				: list_entry(list_front(&cur->child_list), struct child_record, elem);
+		}
+		else
+		{
+			rec = NULL;
+			for (struct list_elem *e = list_begin(&cur->child_list); e != list_end(&cur->child_list); e = list_next(e))
+				if (list_entry(e, struct child_record, elem)->tid == tid)
+				{
+					rec = list_entry(e, struct child_record, elem);
+					break;
+				}
+		}
 
-	sema_down(&child->wait_sema);
-	list_remove(&child->child_elem);
-	int result = child->exit_status;
-	sema_up(&child->exit_sema);
+		// 거둘 자식이 없거나, 이미 종료했거나, 기다리지 않는 경우
+		if (rec == NULL || rec->exited || nohang)
+			break;
 
+		// 자식이 종료할 때까지 잠든다. 깨어나면 목록을 다시 본다.
+		sema_down(&cur->child_sema);
+	}
+
+	if (rec == NULL)
+		result = -1;
+	else if (!rec->exited)
+		result = 0;
+	else
+	{
+		list_remove(&rec->elem);
+		*status = rec->exit_status;
+		result = rec->tid;
+		put_child_record(rec);
+	}
+	intr_set_level(old_level);
 	return result;
 }
 
@@ -352,24 +538,41 @@ void process_exit(void)
     struct thread *cur = thread_current();
 	// printf("process_exit start \n");
 
-    // 1) FDT의 모든 파일을 닫는다.
-    for (int i = 2; i < FDT_COUNT_LIMIT; i++) {
-        process_close_file(i);
-    }
-	// FDT의 메모리를 반환한다.
-	palloc_free_multiple(cur->fdt, FDT_PAGES);
+    // 1) FDT의 열려 있는 파일을 모두 닫고 FDT의 메모리를 반환한다.
+    fdt_destroy(&cur->fdt);
     
 	// 2) 현재 실행 중인 파일도 닫는다.
 	file_close(cur->running); 
     process_cleanup();
+	vamap_destroy(&cur->spt.pages, page_dealloc, NULL);
 
-    // 3) 자식이 종료될 때까지 대기하고 있는 부모에게 signal을 보낸다.
-    sema_up(&cur->wait_sema);
+    // 3) 종료 상태를 기록에 남기고 기다리는 부모를 깨운다. 부모를 기다리지 않으므로
+    //    이어지는 do_schedule(THREAD_DYING)에서 스레드 페이지까지 바로 반환된다.
+    enum intr_level old_level = intr_disable();
+    struct child_record *rec = cur->record;
+    if (rec != NULL)
+    {
+        rec->exit_status = cur->exit_status;
+        rec->exited = true;
+        if (rec->parent != NULL)
+        {
+            // 종료한 자식은 목록의 앞으로 옮겨 아무 자식이나 거둘 때 바로 찾게 한다.
+            list_remove(&rec->elem);
+            list_push_front(&rec->parent->child_list, &rec->elem);
+            sema_up(&rec->parent->child_sema);
+        }
+        put_child_record(rec);
+        cur->record = NULL;
+    }
 
-    // 4) 부모의 signal을 기다린다. 대기가 풀리고 나서 do_schedule(THREAD_DYING)이 이어져 다른 스레드가 실행된다.
-    sema_down(&cur->exit_sema);
-	
-	hash_destroy(&cur->spt.pages, page_dealloc);
+    // 4) 거두지 않은 자식들의 기록을 놓는다. 이미 종료한 자식의 기록은 여기서 해제된다.
+    while (!list_empty(&cur->child_list))
+    {
+        rec = list_entry(list_pop_front(&cur->child_list), struct child_record, elem);
+        rec->parent = NULL;
+        put_child_record(rec);
+    }
+    intr_set_level(old_level);
 	// printf("process_exit end \n");
 }
 
@@ -469,42 +672,32 @@ static bool load_segment(struct file *file, off_t ofs, uint8_t *upage,
 						 uint32_t read_bytes, uint32_t zero_bytes,
 						 bool writable);
 
-/* FILE_NAME에서 ELF 실행 파일을 현재 스레드로 로드합니다.
- * 실행 파일의 진입 지점을 *RIP에 저장하고
- * 초기 스택 포인터를 *RSP에 저장합니다.
- * 성공 시 true를 반환하고, 실패 시 false를 반환합니다. */
-static bool
-load(const char *file_name, struct intr_frame *if_)
+/* FILE의 ELF 헤더와 프로그램 헤더를 읽고 검증하여, 로드할 세그먼트를 담은
+ * 새 이미지를 반환합니다.  FILE_NAME은 오류 메시지에만 씁니다.  실행할 수
+ * 없는 파일이거나 메모리가 부족하면 NULL을 반환합니다. */
+static struct exec_image *
+parse_executable(const char *file_name, struct file *file)
 {
-	struct thread *t = thread_current();
 	struct ELF ehdr;
-	struct file *file = NULL;
+	struct exec_image *image;
 	off_t file_ofs;
-	bool success = false;
 	int i;
 
-	/* Allocate and activate page directory. */
-	t->pml4 = pml4_create(); // 페이지 dir(페이지 테이블 포인터) 생성
-	if (t->pml4 == NULL)
-		goto done;
-	process_activate(thread_current()); // 이 함수 안에서 페이지 테이블 활성화함
-
-	/* Open executable file. */
-	file = filesys_open(file_name);
-	if (file == NULL)
-	{
-		printf("load: %s: open failed\n", file_name);
-		goto done;
-	}
-
 	/* Read and verify executable header. */
 	if (file_read(file, &ehdr, sizeof ehdr) != sizeof ehdr || memcmp(ehdr.e_ident, "\177ELF\2\1\1", 7) || ehdr.e_type != 2 || ehdr.e_machine != 0x3E // amd64
 		|| ehdr.e_version != 1 || ehdr.e_phentsize != sizeof(struct Phdr) || ehdr.e_phnum > 1024)
 	{
 		printf("load: %s: error loading executable\n", file_name);
-		goto done;
+		return NULL;
 	}
 
+	image = malloc(sizeof *image);
+	if (image == NULL)
+		return NULL;
+	image->entry = ehdr.e_entry;
+	image->seg_cnt = 0;
+	image->segs = NULL;
+
 	/* Read program headers. */
 	file_ofs = ehdr.e_phoff;
 	for (i = 0; i < ehdr.e_phnum; i++)
@@ -512,11 +705,9 @@ load(const char *file_name, struct intr_frame *if_)
 		struct Phdr phdr;
 
 		if (file_ofs < 0 || file_ofs > file_length(file))
-			goto done;
-		file_seek(file, file_ofs);
-
-		if (file_read(file, &phdr, sizeof phdr) != sizeof phdr)
-			goto done;
+			goto fail;
+		if (file_read_at(file, &phdr, sizeof phdr, file_ofs) != sizeof phdr)
+			goto fail;
 		file_ofs += sizeof phdr;
 		switch (phdr.p_type)
 		{
@@ -530,7 +721,7 @@ load(const char *file_name, struct intr_frame *if_)
 		case PT_DYNAMIC:
 		case PT_INTERP:
 		case PT_SHLIB:
-			goto done;
+			goto fail;
 		case PT_LOAD:
 			if (validate_segment(&phdr, file))
 			{
@@ -553,26 +744,90 @@ load(const char *file_name, struct intr_frame *if_)
 					read_bytes = 0;
 					zero_bytes = ROUND_UP(page_offset + phdr.p_memsz, PGSIZE);
 				}
-				if (!load_segment(file, file_page, (void *)mem_page,
-								  read_bytes, zero_bytes, writable))
-					goto done;
+
+				struct exec_segment *segs = realloc(image->segs, (image->seg_cnt + 1) * sizeof *segs);
+				if (segs == NULL)
+					goto fail;
+				image->segs = segs;
+				segs[image->seg_cnt++] = (struct exec_segment){
+					.file_page = file_page,
+					.mem_page = (void *)mem_page,
+					.read_bytes = read_bytes,
+					.zero_bytes = zero_bytes,
+					.writable = writable,
+				};
 			}
 			else
-				goto done;
+				goto fail;
 			break;
 		}
 	}
+	return image;
+
+fail:
+	free(image->segs);
+	free(image);
+	return NULL;
+}
+
+/* FILE_NAME에서 ELF 실행 파일을 현재 스레드로 로드합니다.
+ * 실행 파일의 진입 지점을 *RIP에 저장하고
+ * 초기 스택 포인터를 *RSP에 저장합니다.
+ * 성공 시 true를 반환하고, 실패 시 false를 반환합니다. */
+static bool
+load(const char *file_name, struct intr_frame *if_)
+{
+	struct thread *t = thread_current();
+	struct exec_image *image = NULL;
+	struct file *file = NULL;
+	bool success = false;
+	size_t i;
+
+	/* Allocate and activate page directory. */
+	t->pml4 = pml4_create(); // 페이지 dir(페이지 테이블 포인터) 생성
+	if (t->pml4 == NULL)
+		goto done;
+	process_activate(thread_current()); // 이 함수 안에서 페이지 테이블 활성화함
+
+	/* Open executable file. */
+	// filesys_lock은 파일을 여는 동안만 잡는다. 헤더는 파일이 마지막 로드 이후
+	// 바뀌지 않았다면 캐시에서 가져오고, 처음이거나 바뀌었을 때만 다시 읽는다.
+	lock_acquire(&filesys_lock);
+	file = filesys_open(file_name);
+	if (file == NULL)
+		printf("load: %s: open failed\n", file_name);
+	else
+	{
+		image = exec_cache_lookup(file_get_inode(file));
+		if (image == NULL && (image = parse_executable(file_name, file)) != NULL)
+			image = exec_cache_insert(file_get_inode(file), image);
+
+		// 스레드가 삭제될 때 파일을 닫을 수 있게 구조체에 파일을 저장해둔다.
+		// exec 이전에 실행하던 파일은 이제 닫는다.
+		file_close(t->running);
+		t->running = file;
+		// 현재 실행중인 파일은 수정할 수 없게 막는다.
+		file_deny_write(file);
+	}
+	lock_release(&filesys_lock);
+	if (image == NULL)
+		goto done;
+
+	/* 세그먼트를 매핑한다. 헤더를 다시 읽을 필요가 없으므로 락 없이 진행한다. */
+	for (i = 0; i < image->seg_cnt; i++)
+	{
+		struct exec_segment *seg = &image->segs[i];
+		if (!load_segment(file, seg->file_page, seg->mem_page,
+						  seg->read_bytes, seg->zero_bytes, seg->writable))
+			goto done;
+	}
 
-	// 스레드가 삭제될 때 파일을 닫을 수 있게 구조체에 파일을 저장해둔다.
-	t->running = file;
-	// 현재 실행중인 파일은 수정할 수 없게 막는다.
-	file_deny_write(file);
 	/* Set up stack. */
 	if (!setup_stack(if_)) // user stack 초기화
 		goto done;
 
 	/* Start address. */
-	if_->rip = ehdr.e_entry; // entry point 초기화
+	if_->rip = image->entry; // entry point 초기화
 	
 	// rip: 프로그램 카운터(실행할 다음 인스트럭션의 메모리  주소)
 
@@ -585,6 +840,7 @@ done:
 	/* We arrive here whether the load is successful or not. */
 	// 파일을 여기서 닫지 않고 스레드가 삭제될 때 process_exit에서 닫는다.
 	// file_close(file);
+	exec_cache_put(image);
 	return success;
 }
 
@@ -635,56 +891,23 @@ validate_segment(const struct Phdr *phdr, struct file *file)
 
 int process_add_file(struct file *f)
 {
-	struct thread *curr = thread_current();
-	struct file **fdt = curr->fdt;
-
-	// FDT_COUNT_LIMIT를 넘지 않는 범위 안에서 빈 자리룰 탐색한다.
-	while (curr->next_fd < FDT_COUNT_LIMIT && fdt[curr->next_fd])
-		curr->next_fd++;
-	
-	// curr->next_fd가 FDT_COUNT_LIMIT보다 크거나 같다 : 빈 자리가 없다.
-	if (curr->next_fd >= FDT_COUNT_LIMIT)
-		return -1;
-	
-	// 빈 자리가 있다면 그곳에 파일 f를 저장한다.
-	fdt[curr->next_fd] = f;
-
-	// 저장된 파일의 fd를 반환한다.
-	return curr->next_fd;
+	// 비어 있는 가장 작은 fd에 파일 f를 저장하고 그 fd를 반환한다.
+	// 자리가 없으면 -1을 반환한다.
+	return fdt_add(&thread_current()->fdt, f);
 }
 
 struct file *process_get_file(int fd)
 {
-	// printf("process_get_file start!!!\n");
-	struct thread *curr = thread_current();
-	struct file **fdt = curr->fdt;
-
-	// 파일 디스크럽터가 2보다 작다 : 표준 입출력 -> 가져올 수 없다.
-	// 파일 디스크럽터가 FDT_COUNT_LIMIT보다 크거나 같다 : 잘못된 fd
-	if (fd < 2 || fd >= FDT_COUNT_LIMIT)
-		return NULL;
-	
-	// 파일 디스크럽터에 해당하는 파일 객체를 반환한다.
-	// printf("process_get_file end!!!\n");
-	return fdt[fd];
+	// 표준 입출력이나 잘못된 fd이면 NULL을 반환한다.
+	return fdt_get(&thread_current()->fdt, fd);
 }
 
 void process_close_file(int fd)
 {
-    struct thread *curr = thread_current();
-    struct file **fdt = curr->fdt;
-
-	// 파일 디스크럽터가 2보다 작다 : 표준 입출력 -> 가져올 수 없다.
-	// 파일 디스크럽터가 FDT_COUNT_LIMIT보다 크거나 같다 : 잘못된 fd
-    if (fd < 2 || fd >= FDT_COUNT_LIMIT)
-        return;
-
-	// fdt 안에 해당 파일이 존재하면,
-    if (fdt[fd] != NULL)
-    {
-        file_close(fdt[fd]);  // 해당 파일을 닫는다.
-        fdt[fd] = NULL;       // 파일 디스크럽터에서 해당 파일을 지운다.
-    }
+	// fdt 안에 해당 파일이 존재하면 fdt에서 지우고 닫는다.
+	struct file *file = fdt_remove(&thread_current()->fdt, fd);
+	if (file != NULL)
+		file_close(file);
 }
 
 #ifndef VM
@@ -712,7 +935,6 @@ load_segment(struct file *file, off_t ofs, uint8_t *upage,
 	ASSERT(pg_ofs(upage) == 0);
 	ASSERT(ofs % PGSIZE == 0);
 
-	file_seek(file, ofs);
 	while (read_bytes > 0 || zero_bytes > 0)
 	{
 		/* 이 페이지를 채우는 방법을 계산합니다.
@@ -726,8 +948,11 @@ load_segment(struct file *file, off_t ofs, uint8_t *upage,
 		if (kpage == NULL)
 			return false;
 
-		/* 이 페이지를 로드합니다. */
-		if (file_read(file, kpage, page_read_bytes) != (int)page_read_bytes)
+		/* 이 페이지를 로드합니다. load()는 filesys_lock 없이 이 함수를 부른다. */
+		lock_acquire(&filesys_lock);
+		off_t bytes_read = file_read_at(file, kpage, page_read_bytes, ofs);
+		lock_release(&filesys_lock);
+		if (bytes_read != (int)page_read_bytes)
 		{
 			palloc_free_page(kpage);
 			return false;
@@ -746,6 +971,7 @@ load_segment(struct file *file, off_t ofs, uint8_t *upage,
 		read_bytes -= page_read_bytes;
 		zero_bytes -= page_zero_bytes;
 		upage += PGSIZE;
+		ofs += page_read_bytes;
 	}
 	return true;
 }
@@ -789,28 +1015,6 @@ install_page(void *upage, void *kpage, bool writable)
  * If you want to implement the function for only project 2, implement it on the
  * upper block. */
 
-static bool
-lazy_load_segment(struct page *page, void *aux)
-{
-	/* TODO: Load the segment from the file */
-	/* TODO: This called when the first page fault occurs on address VA. */
-	/* TODO: VA is available when calling this function. */
-	struct load_info *info = (struct load_info *)aux;
-	uint8_t *kpage = page->frame->kva;
-
-	file_seek(info->file, info->ofs);
-	if (file_read(info->file, kpage, info->page_read_bytes) != (int)info->page_read_bytes){
-		palloc_free_page(kpage);
-		free(aux);
-		return false;
-	}
-	memset(kpage + info->page_read_bytes, 0, info->page_zero_bytes);
-
-	free(aux);
-
-	return true;
-}
-
 /* Loads a segment starting at offset OFS in FILE at address
  * UPAGE.  In total, READ_BYTES + ZERO_BYTES bytes of virtual
  * memory are initialized, as follows:
@@ -829,42 +1033,15 @@ static bool
 load_segment(struct file *file, off_t ofs, uint8_t *upage,
 			 uint32_t read_bytes, uint32_t zero_bytes, bool writable)
 {
-	// printf("load start!!!\n");
 	ASSERT((read_bytes + zero_bytes) % PGSIZE == 0);
 	ASSERT(pg_ofs(upage) == 0);
 	ASSERT(ofs % PGSIZE == 0);
 
-	file_seek (file, ofs);
-	while (read_bytes > 0 || zero_bytes > 0)
-	{
-		/* Do calculate how to fill this page.
-		 * We will read PAGE_READ_BYTES bytes from FILE
-		 * and zero the final PAGE_ZERO_BYTES bytes. */
-		size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
-		size_t page_zero_bytes = PGSIZE - page_read_bytes;
-
-		/* TODO: Set up aux to pass information to the lazy_load_segment. */
-		struct load_info *aux = (struct load_info  *)malloc(sizeof(struct load_info));
-		if(aux == NULL)	
-			return false;
-		memset(aux, 0, sizeof(struct load_info));  // 메모리 초기화
-		aux->file = file;
-		aux->page_read_bytes = page_read_bytes;
-		aux->page_zero_bytes = page_zero_bytes;
-		aux->writable = writable;
-		aux->ofs = ofs;
-
-		if (!vm_alloc_page_with_initializer(VM_ANON, upage,
-											writable, lazy_load_segment, aux))
-			return false;
-
-		/* Advance. */
-		read_bytes -= page_read_bytes;
-		zero_bytes -= page_zero_bytes;
-		upage += PGSIZE;
-		ofs += page_read_bytes;
-	}
-	return true;
+	/* The segment becomes a single region; its pages are read from FILE
+	 * by vma_load_page() when they are first touched. */
+	return vma_create(&thread_current()->spt, upage,
+					  upage + read_bytes + zero_bytes, VM_ANON, writable,
+					  file, ofs, read_bytes) != NULL;
 }
 
 /* Create a PAGE of stack at the USER_STACK. Return true on success. */
@@ -878,7 +1055,10 @@ setup_stack(struct intr_frame *if_)
 	 * TODO: If success, set the rsp accordingly.
 	 * TODO: You should mark the page is stack. */
 	/* TODO: Your code goes here */
-	if(vm_alloc_page(VM_ANON | VM_MARKER_0, stack_bottom, 1)){
+	struct supplemental_page_table *spt = &thread_current()->spt;
+	spt->stack = vma_create(spt, stack_bottom, (void *)USER_STACK,
+							VM_ANON | VM_MARKER_0, true, NULL, 0, 0);
+	if(spt->stack != NULL){
 		success = vm_claim_page(stack_bottom);
 		if(success){
 			if_->rsp = USER_STACK;
@@ -16,17 +16,32 @@
 #include "filesys/filesys.h"
 #include "filesys/file.h"
 #include "threads/synch.h"
+#include "threads/malloc.h"
 #include "lib/string.h"
+#include <iovec.h>
+#include <limits.h>
+#include <mman.h>
+#include <wait.h>
+#include "userprog/io-ring.h"
+#include "userprog/uaccess.h"
+#include "vm/shm.h"
 
 void syscall_entry(void);
 void syscall_handler(struct intr_frame *);
 
-// void check_address(void *addr);
-struct page * check_address(void * addr);
 void halt(void);
 void exit(int status);
 int fork(const char *thread_name, struct intr_frame *f);
 int wait(int pid);
+int waitpid(int pid, int *status, int options);
+int spawn(const char *cmd_line, const int *fds, size_t fd_cnt);
+int readv(int fd, const struct iovec *iov, int iovcnt);
+int writev(int fd, const struct iovec *iov, int iovcnt);
+int pread(int fd, void *buffer, unsigned size, off_t offset);
+int pwrite(int fd, const void *buffer, unsigned size, off_t offset);
+int copy_file_range(int fd_in, int fd_out, unsigned size);
+int dup2(int oldfd, int newfd);
+int pipe(int *fds);
 void close(int fd);
 bool create(const char *file, unsigned initial_size);
 bool remove(const char *file);
@@ -37,7 +52,6 @@ void seek(int fd, unsigned position);
 unsigned tell(int fd);
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
-void check_valid_buffer(void* buffer, unsigned size, void* rsp, bool to_write);
 
 struct lock filesys_lock;
 
@@ -70,6 +84,7 @@ void syscall_init(void)
 			  FLAG_IF | FLAG_TF | FLAG_DF | FLAG_IOPL | FLAG_AC | FLAG_NT);
 
 	lock_init(&filesys_lock);
+	lock_profile(&filesys_lock, "filesys");
 }
 
 /* The main system call interface */
@@ -120,12 +135,10 @@ void syscall_handler(struct intr_frame *f UNUSED)
 		break;
 
 	case SYS_READ: /* Read from a file. */
-		check_valid_buffer(f->R.rsi, f->R.rdx, f->rsp, 1);
 		f->R.rax = read(f->R.rdi, f->R.rsi, f->R.rdx);
 		break;
 
 	case SYS_WRITE: /* Write to a file. */
-		check_valid_buffer(f->R.rsi, f->R.rdx, f->rsp, 0);
 		f->R.rax = write(f->R.rdi, f->R.rsi, f->R.rdx);
 		break;
 
@@ -146,6 +159,39 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	case SYS_MUNMAP:
 		munmap(f->R.rdi);
 		break;
+	case SYS_SPAWN:
+		f->R.rax = spawn(f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
+	case SYS_READV:
+		f->R.rax = readv(f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
+	case SYS_WRITEV:
+		f->R.rax = writev(f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
+	case SYS_PREAD:
+		f->R.rax = pread(f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10);
+		break;
+	case SYS_PWRITE:
+		f->R.rax = pwrite(f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10);
+		break;
+	case SYS_COPY_FILE_RANGE:
+		f->R.rax = copy_file_range(f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
+	case SYS_IO_RING_SETUP:
+		f->R.rax = io_ring_setup(f->R.rdi);
+		break;
+	case SYS_IO_RING_ENTER:
+		f->R.rax = io_ring_enter(f->R.rdi);
+		break;
+	case SYS_WAITPID:
+		f->R.rax = waitpid(f->R.rdi, f->R.rsi, f->R.rdx);
+		break;
+	case SYS_DUP2:
+		f->R.rax = dup2(f->R.rdi, f->R.rsi);
+		break;
+	case SYS_PIPE:
+		f->R.rax = pipe(f->R.rdi);
+		break;
 
 	default:
 		exit(-1);
@@ -153,6 +199,116 @@ void syscall_handler(struct intr_frame *f UNUSED)
 	}
 }
 
+// 사용자 문자열 USTR을 파일 이름 버퍼 NAME으로 복사한다. 잘못된 주소면 프로세스를 종료하고,
+// 이름이 NAME_MAX보다 길면 그런 파일은 있을 수 없으므로 false를 반환한다.
+static bool copy_in_name(char name[NAME_MAX + 1], const char *ustr)
+{
+	int len = strncpy_from_user(name, ustr, NAME_MAX + 1);
+	if (len < 0)
+		exit(-1);
+	return len <= NAME_MAX;
+}
+
+// 사용자 명령줄 USTR을 커널 페이지 PAGE로 복사한다. 잘못된 주소면 PAGE를 해제하고 종료하며,
+// 한 페이지보다 긴 명령줄은 잘라낸다.
+static void copy_in_cmd_line(char *page, const char *ustr)
+{
+	if (strncpy_from_user(page, ustr, PGSIZE) < 0)
+	{
+		palloc_free_page(page);
+		exit(-1);
+	}
+	page[PGSIZE - 1] = '\0';
+}
+
+// FILE과 사용자 버퍼 UBUF 사이에서 SIZE 바이트를 옮긴다. FILE이 NULL이면 콘솔과 주고받는다.
+// OFFSET이 음수면 파일의 현재 위치에서 옮기고 위치를 전진시킨다.
+// 사용자 메모리는 커널 페이지 BOUNCE를 거쳐 copy_to_user/copy_from_user로만 건드리므로,
+// 버퍼를 미리 검사하지 않아도 잘못된 버퍼는 폴트로 죽는 대신 -1로 돌아온다.
+// needs_filesys_lock(FILE)이면 filesys_lock을 잡은 채로 호출하며, 옮긴 바이트 수를 반환한다.
+int user_io(struct file *file, void *ubuf, size_t size, off_t offset, bool is_write, void *bounce)
+{
+	uint8_t *kbuf = bounce;
+	size_t done = 0;
+
+	while (done < size)
+	{
+		size_t chunk = size - done < PGSIZE ? size - done : PGSIZE;
+		off_t n = chunk;
+
+		if (is_write)
+		{
+			if (!copy_from_user(kbuf, (uint8_t *)ubuf + done, chunk))
+				return -1;
+			if (file == NULL)
+				putbuf((char *)kbuf, chunk);
+			else
+				n = offset < 0 ? file_write(file, kbuf, chunk)
+							   : file_write_at(file, kbuf, chunk, offset + done);
+		}
+		else
+		{
+			if (file == NULL)
+				for (size_t i = 0; i < chunk; i++)
+					kbuf[i] = input_getc();
+			else
+				n = offset < 0 ? file_read(file, kbuf, chunk)
+							   : file_read_at(file, kbuf, chunk, offset + done);
+			if (!copy_to_user((uint8_t *)ubuf + done, kbuf, n))
+				return -1;
+		}
+
+		done += n;
+		if ((size_t)n < chunk)
+			break;
+	}
+	return done;
+}
+
+// FILE에 접근하는 동안 filesys_lock을 잡아야 하면 true를 반환한다.
+// 파이프는 읽기와 쓰기가 상대를 기다리며 막힐 수 있으므로 락 없이 다룬다.
+bool needs_filesys_lock(struct file *file)
+{
+	return file == NULL || !file_is_pipe(file);
+}
+
+// FD가 가리키는 파일을 반환한다. FD에 파일이 없고 IS_WRITE 방향의 콘솔이면 NULL을 넣고,
+// 둘 다 아니면 false를 반환한다. POSITIONED이면 위치를 지정한 전송이므로 콘솔과 파이프는 안 된다.
+static bool lookup_fd(int fd, bool is_write, bool positioned, struct file **file)
+{
+	*file = process_get_file(fd);
+	if (*file == NULL)
+		return fd == (is_write ? STDOUT_FILENO : STDIN_FILENO) && !positioned;
+	return !positioned || !file_is_pipe(*file);
+}
+
+// read, write, pread, pwrite의 공통 부분. FD가 열려 있지 않으면 -1을 반환하고,
+// 잘못된 버퍼였다면 락을 푼 뒤 프로세스를 종료한다.
+static int transfer(int fd, void *buffer, unsigned size, off_t offset, bool is_write)
+{
+	struct file *file;
+	if (!lookup_fd(fd, is_write, offset >= 0, &file))
+		return -1;
+
+	void *bounce = palloc_get_page(0);
+	if (bounce == NULL)
+		return -1;
+
+	// 파일 시스템 작업을 하는 동안, 락을 걸어준다.
+	// 현재 프로세스가 작업을 하는 도중, 다른 프로세스의 접근이 막힌다.
+	bool locked = needs_filesys_lock(file);
+	if (locked)
+		lock_acquire(&filesys_lock);
+	int bytes = user_io(file, buffer, size, offset, is_write, bounce);
+	if (locked)
+		lock_release(&filesys_lock);
+
+	palloc_free_page(bounce);
+	if (bytes == -1)
+		exit(-1);
+	return bytes;
+}
+
 void halt(void)
 {
 	power_off();
@@ -177,6 +333,21 @@ int wait(int pid)
 {
 	return process_wait(pid);
 }
+
+// PID가 WAIT_ANY(-1)이면 아무 자식이나 거둔다. WNOHANG이면 종료한 자식이 없을 때
+// 기다리지 않고 0을 반환한다. 거둔 자식의 pid를 반환하고 STATUS가 NULL이 아니면
+// 종료 상태를 저장한다. 거둘 자식이 없으면 -1을 반환한다.
+int waitpid(int pid, int *status, int options)
+{
+	if (options & ~WNOHANG)
+		return -1;
+
+	int exit_status;
+	pid = process_waitpid(pid, &exit_status, options & WNOHANG);
+	if (pid > 0 && status != NULL && !copy_to_user(status, &exit_status, sizeof exit_status))
+		exit(-1);
+	return pid;
+}
 int fork(const char *thread_name, struct intr_frame *f)
 {
 	return process_fork(thread_name, f);
@@ -184,9 +355,6 @@ int fork(const char *thread_name, struct intr_frame *f)
 
 int exec(char *cmd_line)
 {
-	// cmd_line이 유효한 사용자 주소인지 확인 -> 잘못된 주소인 경우 종료/예외 발생
-	check_address(cmd_line);
-
 	// process.c 파일의 process_create_initd 함수와 유사하다.
 	// 단, 스레드를 새로 생성하는 건 fork에서 수행하므로
 	// exec는 이미 존재하는 프로세스의 컨텍스트를 교체하는 작업을 하므로
@@ -200,13 +368,43 @@ int exec(char *cmd_line)
 	cmd_line_copy = palloc_get_page(PAL_ZERO);
 	if (cmd_line_copy == NULL)
 		exit(-1);							  // 메모리 할당 실패 시 status -1로 종료한다.
-	strlcpy(cmd_line_copy, cmd_line, PGSIZE); // cmd_line을 복사한다.
+	copy_in_cmd_line(cmd_line_copy, cmd_line); // cmd_line을 복사한다.
 
 	// 스레드의 이름을 변경하지 않고 바로 실행한다.
 	if (process_exec(cmd_line_copy) == -1)
 		exit(-1); // 실패 시 status -1로 종료한다.
 }
 
+// fork + exec를 한 번에 한다. 부모의 주소 공간을 복사하지 않고,
+// fds에 나열된 fd만 자식에게 물려준다.
+int spawn(const char *cmd_line, const int *fds, size_t fd_cnt)
+{
+	if (fd_cnt > FDT_COUNT_LIMIT)
+		return -1;
+
+	// 자식이 fd 목록을 읽는 동안 부모는 기다리므로, 커널 메모리에 복사해 둔다.
+	int *fd_list = malloc(fd_cnt * sizeof *fds + 1);
+	if (fd_list == NULL)
+		return -1;
+	if (!copy_from_user(fd_list, fds, fd_cnt * sizeof *fds))
+	{
+		free(fd_list);
+		exit(-1);
+	}
+
+	char *cmd_line_copy = palloc_get_page(0);
+	if (cmd_line_copy == NULL)
+	{
+		free(fd_list);
+		return -1;
+	}
+	copy_in_cmd_line(cmd_line_copy, cmd_line);
+
+	int pid = process_spawn(cmd_line_copy, fd_list, fd_cnt);
+	free(fd_list);
+	return pid;
+}
+
 /**
  * 파일 생성 삭제 시 다음도 고려하면 좋을거 같다.
  * 파일 중복: 이미 존재하는 파일과 같은 이름으로 파일을 생성 불가
@@ -216,26 +414,32 @@ int exec(char *cmd_line)
 
 bool create(const char *file_created, unsigned initial_size)
 {
-	check_address(file_created);
+	char name[NAME_MAX + 1];
+	if (!copy_in_name(name, file_created))
+		return false;
 	lock_acquire(&filesys_lock);
-	bool success = filesys_create(file_created, initial_size);
+	bool success = filesys_create(name, initial_size);
 	lock_release(&filesys_lock);
 	return success;
 }
 
 bool remove(const char *file_removed)
 {
-	check_address(file_removed);
+	char name[NAME_MAX + 1];
+	if (!copy_in_name(name, file_removed))
+		return false;
 	lock_acquire(&filesys_lock);
-	bool success = filesys_remove(file_removed);
+	bool success = filesys_remove(name);
 	lock_release(&filesys_lock);
 	return success;
 }
 
 int open(const char *file_opened)
 {
-	// 파일이름이 유효한지 판단한다.
-	check_address(file_opened);
+	// 파일이름을 커널로 복사한다. 이름이 너무 길면 그런 파일은 없다.
+	char name[NAME_MAX + 1];
+	if (!copy_in_name(name, file_opened))
+		return -1;
 	
 	// 락을 걸어준다.
 	// 여러 프로세스가 동시에 파일 시스템에 접근하는 것을 막기 위해 락을 건다.
@@ -243,7 +447,7 @@ int open(const char *file_opened)
 	lock_acquire(&filesys_lock);
 	
 	// 파일 열기를 시도한다.
-	struct file *cur_file = filesys_open(file_opened);
+	struct file *cur_file = filesys_open(name);
 	
 	// 파일 열기를 실패 시
 	if (cur_file == NULL)
@@ -270,9 +474,6 @@ int filesize(int fd)
 {
 	// 파일 디스크럽터 테이블 fd번째에 있는 파일을 가져온다.
 	struct file *cur_file = process_get_file(fd);
-	
-	// 여기선 check_address()를 쓰면 안 된다.
-	// 파일 디스크럽터 테이블이 커널 영역에 있기 때문이다.
 	if (cur_file == NULL)
 	{
 		return -1;
@@ -282,87 +483,187 @@ int filesize(int fd)
 
 int read(int fd, void *buffer, unsigned size)
 {
-	// STDOUT_FILENO : 1 -> 읽을 수 없다.
-	if(fd == STDOUT_FILENO)
+	// 콘솔인 STDIN_FILENO : 0 -> 한 문자씩 입력받아 buffer에 저장한다. STDOUT_FILENO는 읽을 수 없다.
+	// 그 외에는 파일의 현재 위치에서 읽는다.
+	return transfer(fd, buffer, size, -1, false);
+}
+
+int write(int fd, void *buffer, unsigned size)
+{
+	// 콘솔인 STDOUT_FILENO : 1 -> 콘솔에 출력한다. STDIN_FILENO에는 쓸 수 없다.
+	// 그 외에는 파일의 현재 위치에 쓴다.
+	return transfer(fd, buffer, size, -1, true);
+}
+
+// IOV 배열을 커널로 복사한다. IOVCNT가 범위를 벗어나면 NULL을 반환하고,
+// 배열이 잘못된 주소에 있으면 프로세스를 종료한다. 버퍼들은 옮길 때 검사된다.
+static struct iovec *copy_iov(const struct iovec *iov, int iovcnt)
+{
+	if (iovcnt < 0 || iovcnt > IOV_MAX)
+		return NULL;
+
+	struct iovec *kiov = malloc(iovcnt * sizeof *kiov + 1);
+	if (kiov == NULL)
+		return NULL;
+	if (!copy_from_user(kiov, iov, iovcnt * sizeof *kiov))
+	{
+		free(kiov);
+		exit(-1);
+	}
+	return kiov;
+}
+
+// readv, writev의 공통 부분. 락은 전체 전송 동안 한 번만 잡는다.
+// 중간에 요청보다 적게 읽거나 쓰면 거기서 멈추고, 지금까지 옮긴 바이트 수를 반환한다.
+static int transfer_iov(int fd, const struct iovec *iov, int iovcnt, bool is_write)
+{
+	struct file *file;
+	if (!lookup_fd(fd, is_write, false, &file))
 		return -1;
-	
-	// 버퍼의 주소를 검증한다.
-	check_address(buffer);
-	
-	// 데이터를 저장할 위치를 가리킨다.
-	char *ptr = (char *)buffer;
-	int bytes_read = 0;
-	
-	// 파일 시스템 작업을 하는 동안, 락을 걸어준다.
-	// 현재 프로세스가 작업을 하는 도중, 다른 프로세스의 접근이 막힌다.
-	lock_acquire(&filesys_lock);
-	
-	// STDIN_FILENO : 0 -> 한 문자씩 입력받아 buffer에 저장한다.
-	if (fd == STDIN_FILENO)
+
+	struct iovec *kiov = copy_iov(iov, iovcnt);
+	if (kiov == NULL)
+		return -1;
+
+	// 옮긴 바이트 수를 int로 반환하므로, 길이의 합이 INT_MAX를 넘으면 거부한다.
+	size_t sum = 0;
+	for (int i = 0; i < iovcnt; i++)
 	{
-		for (int i = 0; i < size; i++)
+		if (kiov[i].iov_len > INT_MAX - sum)
 		{
-			*ptr++ = input_getc();
-			bytes_read++;
+			free(kiov);
+			return -1;
 		}
+		sum += kiov[i].iov_len;
 	}
-	// 표준 입력이 아닌 경우
-	// 파일 디스크립터에 연결된 파일을 가져온다.
-	// file_read(file, buffer, size)로, buffer로 읽어온다. 
-	else
+
+	void *bounce = palloc_get_page(0);
+	if (bounce == NULL)
+	{
+		free(kiov);
+		return -1;
+	}
+
+	int total = 0;
+	bool faulted = false;
+	bool locked = needs_filesys_lock(file);
+	if (locked)
+		lock_acquire(&filesys_lock);
+	for (int i = 0; i < iovcnt; i++)
 	{
-		struct file *file = process_get_file(fd);
-		if (file == NULL)
+		int len = kiov[i].iov_len;
+		int n = user_io(file, kiov[i].iov_base, len, -1, is_write, bounce);
+		if (n == -1)
 		{
-			lock_release(&filesys_lock);
-			return -1;
+			faulted = true;
+			break;
 		}
-		bytes_read = file_read(file, buffer, size);
+		total += n;
+		if (n < len)
+			break;
 	}
-	
-	// 락을 풀어주고, bytes_read를 반환한다.
-	lock_release(&filesys_lock);
-	return bytes_read;
+	if (locked)
+		lock_release(&filesys_lock);
+
+	palloc_free_page(bounce);
+	free(kiov);
+	// 잘못된 버퍼였다면 락을 푼 지금 종료한다.
+	if (faulted)
+		exit(-1);
+	return total;
 }
 
-int write(int fd, void *buffer, unsigned size)
+int readv(int fd, const struct iovec *iov, int iovcnt)
+{
+	return transfer_iov(fd, iov, iovcnt, false);
+}
+
+int writev(int fd, const struct iovec *iov, int iovcnt)
 {
-	// STDIN_FILENO : 0 -> 쓸 수 없다.
-	if (fd == STDIN_FILENO)
+	return transfer_iov(fd, iov, iovcnt, true);
+}
+
+// 파일 위치를 바꾸지 않고 OFFSET에서부터 읽는다. 콘솔과 파이프에는 쓸 수 없다.
+int pread(int fd, void *buffer, unsigned size, off_t offset)
+{
+	if (offset < 0)
 		return -1;
+	return transfer(fd, buffer, size, offset, false);
+}
 
-	// 버퍼의 주소를 검증한다.
-	check_address(buffer);
-	int bytes_write = 0;
+// 파일 위치를 바꾸지 않고 OFFSET에서부터 쓴다. 콘솔과 파이프에는 쓸 수 없다.
+int pwrite(int fd, const void *buffer, unsigned size, off_t offset)
+{
+	if (offset < 0)
+		return -1;
+	return transfer(fd, (void *)buffer, size, offset, true);
+}
 
-	// 파일 시스템 작업을 하는 동안, 락을 걸어준다.
-	// 현재 프로세스가 작업을 하는 도중, 다른 프로세스의 접근이 막힌다.
+// fd_in의 현재 위치에서 fd_out의 현재 위치로 size 바이트를 커널 안에서 바로 복사한다.
+// 사용자 버퍼를 거치지 않으므로 버퍼 검증도 필요 없다. 두 파일의 위치는 복사한 만큼 전진한다.
+int copy_file_range(int fd_in, int fd_out, unsigned size)
+{
+	int bytes_copied = -1;
 	lock_acquire(&filesys_lock);
+	struct file *in = process_get_file(fd_in);
+	struct file *out = process_get_file(fd_out);
+	if (in != NULL && out != NULL)
+		bytes_copied = file_copy_range(out, in, size);
+	lock_release(&filesys_lock);
+	return bytes_copied;
+}
 
-	// STDOUT_FILENO : 1 -> size 만큼 buffer에 저장한다.
-	if (fd == STDOUT_FILENO)
-	{
-		putbuf(buffer, size);
-		bytes_write = size;
-	}
-	// 표준 출력이 아닌 경우
-	// 파일 디스크립터에 연결된 파일을 가져온다.
-	// file_write(file, buffer, size)로, buffer에 있는 데이터를 file에 쓴다. 
-	else
+// OLDFD의 파일을 NEWFD에도 연다. NEWFD에 열린 파일이 있으면 먼저 닫는다.
+// NEWFD가 0이나 1이면 그 파일이 콘솔 대신 쓰이고, 닫으면 다시 콘솔이 된다.
+// 콘솔 자체는 파일이 아니므로 복제할 수 없다.
+int dup2(int oldfd, int newfd)
+{
+	struct file *file = process_get_file(oldfd);
+	if (file == NULL || newfd < 0 || newfd >= FDT_COUNT_LIMIT)
+		return -1;
+	if (oldfd == newfd)
+		return newfd;
+
+	lock_acquire(&filesys_lock);
+	struct file *dup = file_duplicate(file);
+	if (dup != NULL)
 	{
-		struct file *file = process_get_file(fd);
-		if (file == NULL)
+		process_close_file(newfd);
+		if (!fdt_install(&thread_current()->fdt, newfd, dup))
 		{
-			lock_release(&filesys_lock);
-			return -1;
+			file_close(dup);
+			dup = NULL;
 		}
-		bytes_write = file_write(file, buffer, size);
 	}
-	// 락을 풀어주고, bytes_write를 반환한다.
 	lock_release(&filesys_lock);
-	return bytes_write;
+	return dup != NULL ? newfd : -1;
 }
 
+// 파이프를 만들어 읽는 쪽 fd를 FDS[0]에, 쓰는 쪽 fd를 FDS[1]에 저장한다.
+// 파이프는 디스크를 거치지 않는 커널 안의 버퍼이므로 filesys_lock이 필요 없다.
+int pipe(int *fds)
+{
+	struct file *read_end, *write_end;
+	if (!file_open_pipe(&read_end, &write_end))
+		return -1;
+
+	int kfds[2];
+	kfds[0] = process_add_file(read_end);
+	kfds[1] = kfds[0] != -1 ? process_add_file(write_end) : -1;
+	if (kfds[1] == -1)
+	{
+		if (kfds[0] != -1)
+			fdt_remove(&thread_current()->fdt, kfds[0]);
+		file_close(read_end);
+		file_close(write_end);
+		return -1;
+	}
+
+	// 잘못된 주소라면 두 fd는 종료하면서 닫힌다.
+	if (!copy_to_user(fds, kfds, sizeof kfds))
+		exit(-1);
+	return 0;
+}
 
 void seek(int fd, unsigned position) 
 {
@@ -377,9 +678,10 @@ unsigned tell(int fd)
 {
 	// 파일 디스크립터에 연결된 파일을 가져온다.
 	struct file *file = process_get_file(fd);
-	if (file != NULL)
-		// file.c의 file_tell()을 활용한다.
-		file_tell(file);
+	if (file == NULL)
+		return -1;
+	// file.c의 file_tell()을 활용한다.
+	return file_tell(file);
 }
 
 void close(int fd)
@@ -393,19 +695,26 @@ void close(int fd)
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset){
 	if (addr == NULL) 
 		return NULL;
-	if (fd < 2 || length == 0)
+	if (length == 0)
 		return NULL;
 	if (pg_round_down(addr) != addr)
 		return NULL;
-	
+
+	// 영역(region) 단위로 한 번에 겹침을 검사한다.
+	void *end = pg_round_up(addr + length);
+	if (end <= addr || is_kernel_vaddr(end - 1)
+	|| vma_overlaps(&thread_current()->spt, addr, end))
+		return NULL;
+
+	// 파일 대신 fork한 자식들과 공유하는 익명 메모리를 매핑한다.
+	if (fd == MAP_SHARED_ANON)
+		return offset == 0 ? do_mmap_shared(addr, end, writable) : NULL;
+
+	if (fd < 2)
+		return NULL;
 	struct file *file = process_get_file(fd);
 	if (file == NULL || file_length(file) == 0 || pg_round_down(offset) != offset)
 		return NULL;
-
-	for (size_t i = 0; i < length; i+=PGSIZE)
-		if(is_kernel_vaddr(addr + i)
-		|| spt_find_page(&thread_current()->spt, addr + i) != NULL)
-			return NULL;
 	
 	return do_mmap(addr, length, writable, file, offset);
 }
@@ -415,31 +724,9 @@ void munmap (void *addr){
 		exit(-1);
 	if (pg_round_down(addr) != addr)
 		exit(-1);
-	struct page *page = spt_find_page(&thread_current()->spt, addr);
-	if (page == NULL || page_get_type(page) != VM_FILE)
+	struct vm_area *area = vma_find(&thread_current()->spt, addr);
+	if (area == NULL || (VM_TYPE(area->type) != VM_FILE && area->shm == NULL))
 		exit(-1);
 	
 	do_munmap(addr);
 }
-
-
-struct page * check_address(void * addr) {
-	if (addr == NULL || is_kernel_vaddr(addr)) {
-		exit(-1);
-	}
-
-	return spt_find_page(&thread_current()->spt, addr);
-}
-
-void check_valid_buffer(void* buffer, unsigned size, void* rsp, bool to_write){
-	if (buffer <= USER_STACK && buffer >= rsp)
-		return;
-	
-	for(int i=0; i<size; i += PGSIZE){ // i++ 로 바꿔야할 수도 있음
-        struct page* page = check_address(buffer + i);
-        if(page == NULL)
-            exit(-1);
-        if(to_write == true && page->is_writable == false)
-            exit(-1);
-    }
-}
\ No newline at end of file
@@ -2,5 +2,9 @@ userprog_SRC  = userprog/process.c	# Process loading.
 userprog_SRC += userprog/exception.c	# User exception handler.
 userprog_SRC += userprog/syscall-entry.S # System call entry.
 userprog_SRC += userprog/syscall.c	# System call handler.
+userprog_SRC += userprog/fdt.c		# File descriptor tables.
+userprog_SRC += userprog/io-ring.c	# Batched I/O rings.
+userprog_SRC += userprog/uaccess.c	# User memory access.
+userprog_SRC += userprog/exec-cache.c	# Parsed executable cache.
 userprog_SRC += userprog/gdt.c		# GDT initialization.
 userprog_SRC += userprog/tss.c		# TSS management.
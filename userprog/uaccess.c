@@ -0,0 +1,93 @@
+/* uaccess.c: Copying to and from user memory.
+ *
+ * These routines do not look up user addresses before using them.  They
+ * only check that the range lies below KERN_BASE and then perform the
+ * access.  Each instruction that touches user memory is listed in the
+ * exception table (section __ex_table) together with a fixup address.
+ * If it faults and the page fault handler cannot resolve the fault, the
+ * handler resumes at the fixup, and the routine reports failure to its
+ * caller rather than the process being killed on the spot.  The caller
+ * can then release its locks before deciding what to do. */
+
+#include "userprog/uaccess.h"
+#include "threads/vaddr.h"
+
+/* Lists the instruction at local label FROM in the exception table with
+ * fixup address local label TO. */
+#define EX_TABLE(FROM, TO) \
+	".pushsection __ex_table, \"a\"\n" \
+	".balign 8\n" \
+	".quad " #FROM ", " #TO "\n" \
+	".popsection\n"
+
+/* Returns true if [UADDR, UADDR + SIZE) is entirely user address space. */
+static bool
+access_ok (const void *uaddr, size_t size) {
+	uintptr_t start = (uintptr_t) uaddr;
+	return start + size >= start && start + size <= KERN_BASE;
+}
+
+/* Copies SIZE bytes from SRC to DST, either of which may be in user
+ * memory.  Returns the number of bytes not copied, which is nonzero only
+ * if the copy faulted.  A fault inside `rep movsb' leaves RCX holding
+ * the remaining count, and the fixup simply skips past it. */
+static size_t
+copy_bytes (void *dst, const void *src, size_t size) {
+	asm volatile ("1: rep movsb\n"
+			"2:\n"
+			EX_TABLE (1b, 2b)
+			: "+c" (size), "+D" (dst), "+S" (src) : : "memory");
+	return size;
+}
+
+/* Reads the byte at user address USRC into *DST.  Returns false if the
+ * read faulted. */
+static bool
+get_byte (uint8_t *dst, const uint8_t *usrc) {
+	bool ok;
+	uint8_t byte = 0;
+
+	/* OK is only set once the load has completed. */
+	asm volatile ("movb $0, %0\n"
+			"1: movb %2, %1\n"
+			"movb $1, %0\n"
+			"2:\n"
+			EX_TABLE (1b, 2b)
+			: "=&q" (ok), "+q" (byte) : "m" (*usrc));
+	*dst = byte;
+	return ok;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel buffer DST.
+ * Returns false if part of the source is not readable user memory. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size) {
+	return access_ok (usrc, size) && copy_bytes (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from kernel buffer SRC to user address UDST.
+ * Returns false if part of the destination is not writable user
+ * memory. */
+bool
+copy_to_user (void *udst, const void *src, size_t size) {
+	return access_ok (udst, size) && copy_bytes (udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC into DST, a
+ * buffer of SIZE bytes.  Returns the length of the string if it fit,
+ * SIZE if no null terminator was found in the first SIZE bytes (DST is
+ * then not terminated), or -1 if the string is not readable user
+ * memory. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size) {
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		if (!is_user_vaddr (usrc + i)
+				|| !get_byte ((uint8_t *) &dst[i], (const uint8_t *) &usrc[i]))
+			return -1;
+		if (dst[i] == '\0')
+			return i;
+	}
+	return size;
+}
@@ -5,6 +5,7 @@
 #include <bitmap.h>
 #include "threads/mmu.h"
 #include "threads/malloc.h"
+#include "vm/zswap.h"
 
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
@@ -33,6 +34,7 @@ vm_anon_init (void) {
 	swap_disk = disk_get(1,1);
 	disk_sector_t size = disk_size(swap_disk);
 	swap_table.swap_used_map = bitmap_create(size / 8);
+	zswap_init();
 }
 
 /* Initialize the file mapping */
@@ -43,6 +45,7 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {
 
 	struct anon_page *anon_page = &page->anon;
 	anon_page->bit_idx = -1;
+	anon_page->zswap_idx = -1;
 	return true;
 }
 
@@ -50,6 +53,15 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {
 static bool
 anon_swap_in (struct page *page, void *kva) {
 	struct anon_page *anon_page = &page->anon;
+
+	if (anon_page->zswap_idx >= 0) {
+		if (!zswap_load(anon_page->zswap_idx, kva))
+			return false;
+		zswap_free(anon_page->zswap_idx);
+		anon_page->zswap_idx = -1;
+		vm_stat_inc(VM_STAT_ZSWAP_LOADS);
+		return true;
+	}
 	
 	int idx = anon_page->bit_idx;
 	if(idx < 0) {
@@ -63,15 +75,43 @@ anon_swap_in (struct page *page, void *kva) {
 
 	anon_page->bit_idx = -1;
 	bitmap_flip(swap_table.swap_used_map, idx);
+	vm_stat_inc(VM_STAT_SWAP_INS);
 
 	return true;
 }
 
+/* Copy the swapped out contents of PAGE into KVA, leaving PAGE and its
+ * swap slot untouched. Used when fork duplicates an evicted page. */
+bool
+anon_swap_copy (struct page *page, void *kva) {
+	if (page->anon.zswap_idx >= 0)
+		return zswap_load(page->anon.zswap_idx, kva);
+
+	int idx = page->anon.bit_idx;
+	if (idx < 0)
+		return false;
+
+	for (int i = 0; i < 8; i++) {
+		disk_sector_t sec_no = (disk_sector_t) idx*8 + i;
+		disk_read(swap_disk, sec_no, kva + SECTOR_SIZE * i);
+	}
+	return true;
+}
+
 /* Swap out the page by writing contents to the swap disk. */
 static bool
 anon_swap_out (struct page *page) {
 	struct anon_page *anon_page = &page->anon;
 	struct frame *victim_frame = page->frame;
+
+	/* Try the compressed cache first; the disk is the fallback. */
+	anon_page->zswap_idx = zswap_store(victim_frame->kva);
+	if (anon_page->zswap_idx >= 0) {
+		pml4_clear_page(victim_frame->pml4, page->va);
+		vm_stat_inc(VM_STAT_ZSWAP_STORES);
+		return true;
+	}
+
 	int idx = bitmap_scan(swap_table.swap_used_map, 0, 1, false);
 	if (idx == BITMAP_ERROR) {
 		return false;
@@ -83,8 +123,9 @@ anon_swap_out (struct page *page) {
 	}
 
 	anon_page->bit_idx = idx;
-	pml4_clear_page(thread_current()->pml4, page->va);
+	pml4_clear_page(victim_frame->pml4, page->va);
 	bitmap_flip(swap_table.swap_used_map, idx);
+	vm_stat_inc(VM_STAT_SWAP_OUTS);
 
 	return true;
 }
@@ -93,15 +134,15 @@ anon_swap_out (struct page *page) {
 static void
 anon_destroy (struct page *page) {
 	struct anon_page *anon_page = &page->anon;
-	// TODOTODO : pml4 에서 삭제, spt 에서 삭제, frame 삭제 해야하지 않을까?
-	struct thread *cur = thread_current();
-	hash_delete(&cur->spt.pages, &page->page_elem);
-	if (page->frame){
-		pml4_clear_page(cur->pml4, page->va);
-		palloc_free_page(page->frame->kva); 
-		list_remove(&page->frame->frame_elem);
-		free(page->frame);
-		page->frame = NULL;
+
+	/* Give the swap slot back, if the page was evicted. */
+	if (anon_page->zswap_idx >= 0) {
+		zswap_free(anon_page->zswap_idx);
+		anon_page->zswap_idx = -1;
 	}
-	
+	if (anon_page->bit_idx >= 0) {
+		bitmap_reset(swap_table.swap_used_map, anon_page->bit_idx);
+		anon_page->bit_idx = -1;
+	}
+	vm_free_frame(page);
 }
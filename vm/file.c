@@ -10,7 +10,6 @@
 static bool file_backed_swap_in (struct page *page, void *kva);
 static bool file_backed_swap_out (struct page *page);
 static void file_backed_destroy (struct page *page);
-static bool lazy_load_file(struct page *page, void *aux);
 
 /* DO NOT MODIFY this struct */
 static const struct page_operations file_ops = {
@@ -32,6 +31,16 @@ file_backed_initializer (struct page *page, enum vm_type type, void *kva) {
 	page->operations = &file_ops;
 
 	struct file_page *file_page = &page->file;
+	struct vm_area *area = page->area;
+	size_t offset = (uint8_t *) page->va - (uint8_t *) area->start;
+
+	file_page->file = area->file;
+	file_page->ofs = area->ofs + offset;
+	file_page->page_read_bytes = 0;
+	if (offset < area->read_bytes)
+		file_page->page_read_bytes = area->read_bytes - offset < PGSIZE
+			? area->read_bytes - offset : PGSIZE;
+	file_page->page_zero_bytes = PGSIZE - file_page->page_read_bytes;
 	return true;
 }
 
@@ -48,7 +57,8 @@ file_backed_swap_in (struct page *page, void *kva) {
 /* Swap out the page by writeback contents to the file. */
 static bool
 file_backed_swap_out (struct page *page) {
-	uint64_t *pml4 = thread_current()->pml4;
+	/* The victim may belong to another process than the one evicting. */
+	uint64_t *pml4 = page->frame->pml4;
 	struct file_page *file_page = &page->file;
 
 	if(pml4_is_dirty(pml4, page->va)){
@@ -68,21 +78,13 @@ static void
 file_backed_destroy (struct page *page) {
 	struct file_page *file_page = &page->file;
 	uint64_t *pml4 = thread_current()->pml4;
-	struct supplemental_page_table *spt = &thread_current()->spt;
-
-	hash_delete(&spt->pages, &page->page_elem);
 
 	if(page->frame != NULL){
 		// 페이지가 수정되었는지 확인
 		if(pml4_is_dirty(pml4, page->va))// 페이지가 수정되었으면 디스크에 있는 파일에 반영
-			file_write_at(file_page->file, page->va, file_page->page_read_bytes, file_page->ofs);
-		
-		pml4_clear_page(pml4, page->va);
-		palloc_free_page(page->frame->kva);
-
-		list_remove(&page->frame->frame_elem);
-		free(page->frame);
-		page->frame = NULL;
+			file_write_at(file_page->file, page->frame->kva, file_page->page_read_bytes, file_page->ofs);
+
+		vm_free_frame(page);
 	}
 }
 
@@ -90,77 +92,27 @@ file_backed_destroy (struct page *page) {
 void *
 do_mmap (void *addr, size_t length, int writable,
 		struct file *file, off_t offset) {
-	void *result = addr;
-	size_t file_start_page = addr;
-	size_t file_end_page = addr + length;
+	struct supplemental_page_table *spt = &thread_current()->spt;
 	off_t file_size = file_length(file);
-	length = file_size > length ? length : file_size;
-
-	while (length > 0){
-		size_t read_bytes = length > PGSIZE ? PGSIZE : length;
-		size_t zero_bytes = PGSIZE - read_bytes;
-
-		struct load_info *aux = malloc(sizeof(struct load_info));
-		aux->file = file_reopen(file);
-		aux->ofs = offset;
-		aux->writable = writable;
-		aux->page_read_bytes = read_bytes;
-		aux->page_zero_bytes = zero_bytes;
-		aux->file_start_page = file_start_page;
-		aux->file_end_page = file_end_page;
-
-		if(!vm_alloc_page_with_initializer(VM_FILE, addr, writable, lazy_load_file, aux))
-			return NULL;
-		
-		offset += read_bytes;
-		length -= read_bytes;
-		addr += read_bytes;
-		// TODO : 중간에 실패하면 기존에 만들었던 aux를 free해야되지 않을까?
-	}
-	return result;
+	size_t read_bytes = offset < file_size ? file_size - offset : 0;
+	if (read_bytes > length)
+		read_bytes = length;
+
+	/* The whole mapping is one region; its pages are only created when
+	 * they are first touched. */
+	if (vma_create(spt, addr, pg_round_up(addr + length), VM_FILE,
+			writable, file, offset, read_bytes) == NULL)
+		return NULL;
+	return addr;
 }
 
 /* Do the munmap */
 void
 do_munmap (void *addr) {
 	struct supplemental_page_table *spt = &thread_current()->spt;
-	struct page *page = spt_find_page(spt, addr);
-	if (page == NULL)
+	struct vm_area *area = vma_find(spt, addr);
+	if (area == NULL || area->start != addr)
 		return;
-	struct file_page file_page = page->file;
-	if(file_page.file_start_page != addr)
-		return;
-
-	for(void *va = addr; va < file_page.file_end_page; va += PGSIZE){
-		struct page *p = spt_find_page(spt, va);
-		if(p == NULL)
-			return;
 
-		spt_remove_page(spt, p);
-	}
+	vma_destroy(spt, area);
 }
-
-static bool lazy_load_file(struct page *page, void *aux){
-	struct load_info *info = (struct load_info *)aux;
-	uint8_t *kpage = page->frame->kva;
-
-	file_seek(info->file, info->ofs);
-	int read_bytes = file_read(info->file, kpage, info->page_read_bytes);
-	if (read_bytes != (int)info->page_read_bytes){
-		palloc_free_page(kpage);
-		free(aux);
-		return false;
-	}
-	memset(kpage + info->page_read_bytes, 0, info->page_zero_bytes);
-
-	page->file.file = info->file;
-	page->file.file_start_page = info->file_start_page;
-	page->file.file_end_page = info->file_end_page;
-	page->file.page_read_bytes = info->page_read_bytes;
-	page->file.page_zero_bytes = info->page_zero_bytes;
-	page->file.ofs = info->ofs;
-
-	free(aux);
-
-	return true;
-}
\ No newline at end of file
@@ -0,0 +1,103 @@
+/* shm.c: Anonymous memory shared across fork().
+ *
+ * A shared region has no `struct page`s.  A fault inside it maps the
+ * region's frame for that page straight into the page table, the same
+ * frame in every process, and tearing the region down only clears the
+ * page table entries: the frames belong to the shared object and are
+ * freed with its last reference. */
+
+#include "vm/shm.h"
+#include "threads/malloc.h"
+#include "threads/mmu.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+
+/* Creates shared memory of PAGE_CNT pages with one reference. */
+static struct shm *
+shm_create (size_t page_cnt) {
+	struct shm *shm = malloc (sizeof *shm);
+	if (shm == NULL)
+		return NULL;
+	shm->frames = calloc (page_cnt, sizeof *shm->frames);
+	if (shm->frames == NULL) {
+		free (shm);
+		return NULL;
+	}
+	shm->page_cnt = page_cnt;
+	shm->refs = 1;
+	lock_init (&shm->lock);
+	return shm;
+}
+
+/* Maps new shared anonymous memory at [ADDR, END) in the current
+ * process.  Returns ADDR, or NULL if the range is taken or memory is
+ * short. */
+void *
+do_mmap_shared (void *addr, void *end, bool writable) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct shm *shm = shm_create (((uint8_t *) end - (uint8_t *) addr) / PGSIZE);
+	if (shm == NULL)
+		return NULL;
+
+	struct vm_area *area = vma_create (spt, addr, end, VM_ANON, writable,
+			NULL, 0, 0);
+	if (area == NULL) {
+		shm_put (shm);
+		return NULL;
+	}
+	area->shm = shm;
+	return addr;
+}
+
+/* Returns another reference to SHM. */
+struct shm *
+shm_ref (struct shm *shm) {
+	lock_acquire (&shm->lock);
+	shm->refs++;
+	lock_release (&shm->lock);
+	return shm;
+}
+
+/* Drops a reference to SHM, freeing it and its frames with the last. */
+void
+shm_put (struct shm *shm) {
+	lock_acquire (&shm->lock);
+	bool last = --shm->refs == 0;
+	lock_release (&shm->lock);
+	if (!last)
+		return;
+
+	for (size_t i = 0; i < shm->page_cnt; i++)
+		if (shm->frames[i] != NULL)
+			palloc_free_page (shm->frames[i]);
+	free (shm->frames);
+	free (shm);
+}
+
+/* Returns the frame of page IDX of SHM, allocating a zeroed one on first
+ * use.  Returns NULL if the user pool is exhausted. */
+void *
+shm_get_frame (struct shm *shm, size_t idx) {
+	ASSERT (idx < shm->page_cnt);
+
+	lock_acquire (&shm->lock);
+	if (shm->frames[idx] == NULL)
+		shm->frames[idx] = palloc_get_page (PAL_USER | PAL_ZERO);
+	void *kva = shm->frames[idx];
+	lock_release (&shm->lock);
+	return kva;
+}
+
+/* Clears every page table entry of the current process that maps a
+ * frame of shared region AREA, so that destroying the page table does
+ * not free frames other processes still use. */
+void
+shm_unmap (struct vm_area *area) {
+	uint64_t *pml4 = thread_current ()->pml4;
+
+	for (uint8_t *va = area->start; va < (uint8_t *) area->end; va += PGSIZE)
+		if (pml4_get_page (pml4, va) != NULL)
+			pml4_clear_page (pml4, va);
+}
@@ -65,4 +65,7 @@ uninit_destroy (struct page *page) {
 	struct uninit_page *uninit UNUSED = &page->uninit;
 	/* TODO: Fill this function.
 	 * TODO: If you don't have anything to do, just return. */
+	/* An untouched page may still be reading the shared zero page, which
+	 * pml4_destroy() must not free. */
+	vm_unmap_zero (page);
 }
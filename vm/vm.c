@@ -3,23 +3,37 @@
 #include "threads/malloc.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
+#include "vm/shm.h"
 #include "threads/mmu.h"
+#include "threads/trace.h"
 #include "userprog/process.h"
 #include "userprog/syscall.h"
+#include <stdio.h>
 #include <string.h>
+#include "intrinsic.h"
 
-static unsigned
-page_hash (const struct hash_elem *p_, void *aux UNUSED);
-static bool
-page_less (const struct hash_elem *a_,
-           const struct hash_elem *b_, void *aux UNUSED);
+#define CR0_WP (1 << 16)        /* Write-Protect enable in kernel mode. */
 
 static struct page *page_lookup (struct supplemental_page_table *spt, const void *address);
+static struct page *area_page_alloc (struct vm_area *area, void *va,
+		vm_initializer *init);
+static struct page *spt_get_page (struct supplemental_page_table *spt,
+		void *va);
 
 struct list frame_table;
 
 struct lock frame_table_lock;
 
+/* Frame of zeros, mapped read-only at every anonymous page that has been
+ * read but never written.  It is not part of the frame table and is
+ * never evicted or freed. */
+static void *zero_page;
+
+/* System-wide VM counters; per-thread ones live in struct thread. */
+static long long vm_stats[VM_STAT_CNT];
+
+static void inspect_vm_stat (struct intr_frame *f);
+
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
 void
@@ -29,12 +43,20 @@ vm_init (void) {
 	list_init(&frame_table);
 
 	lock_init(&frame_table_lock);
+	lock_profile(&frame_table_lock, "frame table");
+	zero_page = palloc_get_page(PAL_ASSERT | PAL_ZERO);
+	/* The zero page is mapped read-only into every process.  Without
+	 * CR0.WP a kernel write through a user pointer, such as read() into
+	 * a buffer that has only been read, would ignore that and clobber
+	 * the zero page for everyone.  start.S turns it on. */
+	ASSERT (rcr0 () & CR0_WP);
 #ifdef EFILESYS  /* For project 4 */
 	pagecache_init ();
 #endif
 	register_inspect_intr ();
 	/* DO NOT MODIFY UPPER LINES. */
 	/* TODO: Your code goes here. */
+	intr_register_int (0x45, 3, INTR_OFF, inspect_vm_stat, "Inspect VM Stats");
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -55,6 +77,7 @@ page_get_type (struct page *page) {
 static struct frame *vm_get_victim (void);
 static bool vm_do_claim_page (struct page *page);
 static struct frame *vm_evict_frame (void);
+static bool page_needs_io (struct page *page);
 
 /* Create the pending page object with initializer. If you want to create a
  * page, do not create it directly and make it through this function or
@@ -112,22 +135,22 @@ spt_insert_page (struct supplemental_page_table *spt UNUSED,
 		struct page *page UNUSED) {
 	int succ = false;
 	/* TODO: Fill this function. */
-	struct hash_elem * result = hash_insert(&spt->pages, &page->page_elem);
-	if(result == NULL)
-		succ = true;
+	succ = vamap_insert(&spt->pages, page->va, page);
 	return succ;
 }
 
 void
 spt_remove_page (struct supplemental_page_table *spt, struct page *page) {
+	vamap_delete (&spt->pages, page->va);
 	vm_dealloc_page (page);
-	return true;
 }
 
-/* Get the struct frame, that will be evicted. */
+/* Get the struct frame, that will be evicted.
+ * The caller must hold frame_table_lock. */
 static struct frame *
 vm_get_victim (void) {
 	 /* TODO: The policy for eviction is up to you. */
+	ASSERT (lock_held_by_current_thread (&frame_table_lock));
 	struct list_elem *e = list_pop_front(&frame_table);
 	struct frame *victim = list_entry(e, struct frame, frame_elem);
 
@@ -138,20 +161,28 @@ vm_get_victim (void) {
  * Return NULL on error.*/
 static struct frame *
 vm_evict_frame (void) {
+	/* Hold the frame table until the victim is unlinked from its page,
+	 * so that its owner cannot free the page or the frame meanwhile. */
+	lock_acquire(&frame_table_lock);
 	struct frame *victim = vm_get_victim ();
 	/* TODO: swap out the victim and return the evicted frame. */
 	struct page *victim_page = victim->page;
 	
-	if(swap_out(victim_page)) {
-
-		victim_page->frame = NULL;
-		victim->page = NULL;
-		memset(victim->kva, 0, PGSIZE);
-
-		return victim;
+	vm_stat_inc (VM_STAT_EVICTIONS);
+	trace (TRACE_EVICT, 0, (uint64_t) victim_page->va);
+	if(!swap_out(victim_page)) {
+		list_push_back(&frame_table, &victim->frame_elem);
+		lock_release(&frame_table_lock);
+		return NULL;
 	}
 
-	return NULL;
+	victim_page->frame = NULL;
+	victim->page = NULL;
+	victim->pml4 = NULL;
+	lock_release(&frame_table_lock);
+	memset(victim->kva, 0, PGSIZE);
+
+	return victim;
 }
 
 /* palloc() and get frame. If there is no available page, evict the page
@@ -165,6 +196,7 @@ vm_get_frame (void) {
 	/* TODO: Fill this function. */
 	frame->kva = palloc_get_page(PAL_USER);
 	frame->page = NULL;
+	frame->pml4 = NULL;
 	if(frame->kva == NULL) {
 		free(frame);
 		frame = vm_evict_frame();
@@ -182,14 +214,92 @@ vm_get_frame (void) {
 /* Growing the stack. */
 static void
 vm_stack_growth (void *addr UNUSED) {
-    if(vm_alloc_page(VM_ANON | VM_MARKER_0, pg_round_down(addr), 1))
-		thread_current()->stack_bottom -= PGSIZE;
-	
+	struct thread *cur = thread_current();
+	struct vm_area *stack = cur->spt.stack;
+
+	/* Only the stack region is grown here, the page itself is created by
+	 * the fault that follows. */
+	if (stack != NULL && pg_round_down(addr) < stack->start
+			&& vma_extend_down(&cur->spt, stack, pg_round_down(addr))) {
+		cur->stack_bottom = stack->start;
+		vm_stat_inc(VM_STAT_STACK_GROWTHS);
+	}
+}
+
+/* Returns true if PAGE currently maps the shared zero page. */
+static bool
+page_is_zero_mapped (struct page *page) {
+	return page->frame == NULL
+		&& pml4_get_page (thread_current ()->pml4, page->va) == zero_page;
+}
+
+/* Returns true if PAGE would be filled with nothing but zeros when claimed:
+ * an untouched anonymous page of a region with no file data at its
+ * offset. */
+static bool
+page_is_zero_fill (struct page *page) {
+	return VM_TYPE (page->operations->type) == VM_UNINIT
+		&& VM_TYPE (page->uninit.type) == VM_ANON
+		&& page->uninit.init == vma_load_page
+		&& page->area != NULL && !page_needs_io (page);
+}
+
+/* Maps the shared zero page read-only at PAGE. */
+static bool
+vm_map_zero (struct page *page) {
+	if (!pml4_set_page (thread_current ()->pml4, page->va, zero_page, false))
+		return false;
+	vm_stat_inc (VM_STAT_ZERO_MAPS);
+	return true;
+}
+
+/* Removes the zero page mapping of PAGE, if it has one. */
+void
+vm_unmap_zero (struct page *page) {
+	if (page_is_zero_mapped (page))
+		pml4_clear_page (thread_current ()->pml4, page->va);
 }
 
 /* Handle the fault on write_protected page */
 static bool
 vm_handle_wp (struct page *page UNUSED) {
+	/* The only write-protected pages we hand out on purpose are zero page
+	 * mappings: the first write gives the page a private frame. */
+	if (page == NULL || !page->is_writable || !page_is_zero_mapped (page))
+		return false;
+	return vm_do_claim_page (page);
+}
+
+/* Maps the frame of shared region AREA that backs VA. */
+static bool
+vm_map_shared (struct vm_area *area, void *va) {
+	size_t idx = ((uint8_t *) va - (uint8_t *) area->start) / PGSIZE;
+	void *kva = shm_get_frame (area->shm, idx);
+
+	if (kva == NULL
+			|| !pml4_set_page (thread_current ()->pml4, va, kva, area->writable))
+		return false;
+	vm_stat_inc (VM_STAT_MINOR_FAULTS);
+	return true;
+}
+
+/* Returns true if bringing PAGE in has to read from a disk, which makes
+ * the fault a major one. */
+static bool
+page_needs_io (struct page *page) {
+	switch (VM_TYPE (page->operations->type)) {
+		case VM_UNINIT:
+			if (page->area == NULL || page->area->file == NULL)
+				return false;
+			return (size_t) ((uint8_t *) page->va - (uint8_t *) page->area->start)
+				< page->area->read_bytes;
+		case VM_ANON:
+			return page->anon.bit_idx >= 0;
+		case VM_FILE:
+			return page->file.page_read_bytes > 0;
+		default:
+			return false;
+	}
 }
 
 /* Return true on success */
@@ -197,13 +307,18 @@ bool
 vm_try_handle_fault (struct intr_frame *f, void *addr,
 		bool user, bool write, bool not_present) {
 	struct supplemental_page_table *spt = &thread_current ()->spt;
+	vm_stat_inc(VM_STAT_FAULTS);
+	trace(TRACE_FAULT, write | user << 1, (uint64_t) addr);
 	/* TODO: Validate the fault */
 	if(addr == NULL || is_kernel_vaddr(addr)){
 		return false;
 	}
 	
 	if (!not_present){
-		return false;
+		if (!write || !vm_handle_wp (spt_find_page (spt, addr)))
+			return false;
+		vm_stat_inc (VM_STAT_MINOR_FAULTS);
+		return true;
 	}
 
 	void *rsp = f->rsp; // user access인 경우 rsp는 유저 stack을 가리킨다.
@@ -216,14 +331,34 @@ vm_try_handle_fault (struct intr_frame *f, void *addr,
 	
 	struct page *page = spt_find_page(spt, addr);
 	if (page == NULL){
-		return false;
+		/* First touch of a page inside a region. */
+		struct vm_area *area = vma_find(spt, addr);
+		if (area == NULL || (write && !area->writable))
+			return false;
+		if (area->shm != NULL)
+			return vm_map_shared(area, pg_round_down(addr));
+		page = area_page_alloc(area, pg_round_down(addr), vma_load_page);
+		if (page == NULL)
+			return false;
 	}
 	if (write && !page->is_writable){
 		return false;
 	}
 	
 	/* TODO: Your code goes here */
+	/* Reading a page that would only be zero-filled does not need a frame
+	 * of its own until it is written. */
+	if (!write && page_is_zero_fill(page)) {
+		if (!vm_map_zero(page))
+			return false;
+		vm_stat_inc(VM_STAT_MINOR_FAULTS);
+		return true;
+	}
+
+	bool major = page_needs_io(page);
 	bool success = vm_do_claim_page (page);
+	if (success)
+		vm_stat_inc(major ? VM_STAT_MAJOR_FAULTS : VM_STAT_MINOR_FAULTS);
 	return success;
 }
 
@@ -239,7 +374,7 @@ vm_dealloc_page (struct page *page) {
 bool
 vm_claim_page (void *va UNUSED) {
 	struct thread *cur = thread_current();
-	struct page *page = spt_find_page(&cur->spt, va);
+	struct page *page = spt_get_page(&cur->spt, va);
 	/* TODO: Fill this function */
 	if (page == NULL){
 		return false;
@@ -250,6 +385,7 @@ vm_claim_page (void *va UNUSED) {
 /* Claim the PAGE and set up the mmu. */
 static bool
 vm_do_claim_page (struct page *page) {
+	vm_unmap_zero (page);
 	struct frame *frame = vm_get_frame ();
 
 	/* Set links */
@@ -259,74 +395,147 @@ vm_do_claim_page (struct page *page) {
 	/* TODO: Insert page table entry to map page's VA to frame's PA. */
 
 	struct thread *cur = thread_current();
+	frame->pml4 = cur->pml4;
 	pml4_set_page(cur->pml4, page->va, frame->kva, page->is_writable);
 	return swap_in(page, frame->kva);
 }
 
-/* Initialize new supplemental page table */
-void
+/* Initialize new supplemental page table.  Returns false if memory for
+ * the page map cannot be allocated; SPT can still be killed then. */
+bool
 supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
-	hash_init (&spt->pages, page_hash, page_less, NULL);
+	spt->areas = NULL;
+	spt->stack = NULL;
+	spt->dying = false;
+	return vamap_init (&spt->pages);
 }
 
-/* Returns a hash value for page p. */
-unsigned
-page_hash (const struct hash_elem *p_, void *aux UNUSED) {
-  const struct page *p = hash_entry (p_, struct page, page_elem);
-  return hash_bytes (&p->va, sizeof p->va);
-}
+/* Creates the page at VA of AREA, to be filled by INIT when claimed.
+ * Returns NULL if allocation fails. */
+static struct page *
+area_page_alloc (struct vm_area *area, void *va, vm_initializer *init) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
 
-/* Returns true if page a precedes page b. */
-bool
-page_less (const struct hash_elem *a_,
-           const struct hash_elem *b_, void *aux UNUSED) {
-  const struct page *a = hash_entry (a_, struct page, page_elem);
-  const struct page *b = hash_entry (b_, struct page, page_elem);
+	if (!vm_alloc_page_with_initializer (area->type, va, area->writable,
+				init, area))
+		return NULL;
 
-  return a->va < b->va;
+	struct page *page = spt_find_page (spt, va);
+	page->area = area;
+	list_push_back (&area->pages, &page->area_elem);
+	return page;
+}
+
+/* Returns the page at VA, creating it from its region if it has not been
+ * touched yet.  Returns NULL if VA is not mapped at all. */
+static struct page *
+spt_get_page (struct supplemental_page_table *spt, void *va) {
+	struct page *page = spt_find_page (spt, va);
+	if (page == NULL) {
+		struct vm_area *area = vma_find (spt, va);
+		if (area != NULL)
+			page = area_page_alloc (area, pg_round_down (va), vma_load_page);
+	}
+	return page;
 }
 
 /* Returns the page containing the given virtual address, or a null pointer if no such page exists. */
 struct page *
 page_lookup (struct supplemental_page_table *spt, const void *va) {
-	struct page p;
-	struct hash_elem *e;
-	
-	p.va = pg_round_down(va);
-	e = hash_find (&spt->pages, &p.page_elem);
-	return e != NULL ? hash_entry (e, struct page, page_elem) : NULL;
+	return vamap_find (&spt->pages, pg_round_down (va));
 }
 
-/* Copy supplemental page table from src to dst */
+/* Copy supplemental page table from src to dst.
+ * Regions are copied as a whole; only the pages the parent has actually
+ * touched are duplicated, the rest are created lazily in the child.
+ * Shared regions are not copied at all: the child's region refers to the
+ * same frames, which it maps as it touches them. */
 bool
 supplemental_page_table_copy (struct supplemental_page_table *dst,
 		struct supplemental_page_table *src) {
-	struct hash_iterator i;
-	struct hash_elem *elem;
-	hash_first(&i, &src->pages);
-	while ((elem = hash_next(&i))){
-		struct page *p = hash_entry(elem, struct page, page_elem);
-		enum vm_type type = page_get_type(p);
-
-		if (VM_TYPE(p->operations->type) == VM_UNINIT){
-			//if(!vm_alloc_page_with_initializer(VM_ANON, p->va, p->is_writable, p->uninit.init, p->uninit.aux)) // 왜 ANON?
-			struct load_info *copy_aux = (struct load_info *)malloc(sizeof(struct load_info));
-			memcpy(copy_aux, p->uninit.aux, sizeof(struct load_info));
-			if(!vm_alloc_page_with_initializer(type, p->va, p->is_writable, p->uninit.init, copy_aux))
+	for (struct vm_area *a = vma_first(src); a != NULL; a = vma_next(src, a)) {
+		struct vm_area *copy_area = vma_create(dst, a->start, a->end, a->type,
+				a->writable, a->file, a->ofs, a->read_bytes);
+		if (copy_area == NULL)
+			return false;
+		if (src->stack == a)
+			dst->stack = copy_area;
+		if (a->shm != NULL)
+			copy_area->shm = shm_ref(a->shm);
+
+		struct list_elem *e;
+		for (e = list_begin(&a->pages); e != list_end(&a->pages); e = list_next(e)){
+			struct page *p = list_entry(e, struct page, area_elem);
+
+			/* A page never claimed, or a file-backed page that is not
+			 * resident and thus written back, is simply loaded again by
+			 * the child. */
+			if (VM_TYPE(p->operations->type) == VM_UNINIT
+					|| (p->frame == NULL && page_get_type(p) == VM_FILE))
+				continue;
+
+			struct page *copy = area_page_alloc(copy_area, p->va, NULL);
+			if (copy == NULL || !vm_do_claim_page(copy))
 				return false;
-		}else{
-			if(vm_alloc_page(type, p->va, p->is_writable)
-			&& vm_claim_page(p->va)){
-				struct page* copy = spt_find_page(dst, p->va);
+			if (p->frame != NULL)
 				memcpy(copy->frame->kva, p->frame->kva, PGSIZE);
-				copy->frame->page = copy;
-			}else
+			else if (!anon_swap_copy(p, copy->frame->kva))
 				return false;
 		}
-		
 	}
 	return true;
-	
+}
+
+/* Releases the frame of PAGE, if any.
+ * While the whole address space is being killed the page table entry is
+ * left alone: the caller already holds frame_table_lock, and
+ * pml4_destroy() frees every frame that is still mapped, so there is no
+ * need to clear (and flush) the entries one by one.
+ * PAGE->frame is only read under the lock, since another thread may be
+ * evicting it. */
+void
+vm_free_frame (struct page *page) {
+	bool dying = thread_current ()->spt.dying;
+	struct frame *frame;
+
+	if (!dying)
+		lock_acquire (&frame_table_lock);
+	frame = page->frame;
+	if (frame != NULL) {
+		list_remove (&frame->frame_elem);
+		page->frame = NULL;
+	}
+	if (!dying)
+		lock_release (&frame_table_lock);
+	if (frame == NULL)
+		return;
+
+	if (!dying) {
+		pml4_clear_page (thread_current ()->pml4, page->va);
+		palloc_free_page (frame->kva);
+	}
+	free (frame);
+}
+
+/* Writes back the contents of page P_ if it is a dirty, resident
+ * file-backed page.  AUX is the page table. */
+static void
+page_writeback (void *p_, void *aux) {
+	struct page *p = p_;
+	uint64_t *pml4 = aux;
+
+	if (p->frame == NULL || VM_TYPE (p->operations->type) != VM_FILE
+			|| !pml4_is_dirty (pml4, p->va))
+		return;
+	file_write_at (p->file.file, p->frame->kva, p->file.page_read_bytes,
+			p->file.ofs);
+	pml4_set_dirty (pml4, p->va, false);
+}
+
+/* Writes back the contents of every dirty, resident file-backed page. */
+static void
+spt_writeback (struct supplemental_page_table *spt) {
+	vamap_apply (&spt->pages, page_writeback, thread_current ()->pml4);
 }
 
 /* Free the resource hold by the supplemental page table */
@@ -334,12 +543,65 @@ void
 supplemental_page_table_kill (struct supplemental_page_table *spt UNUSED) {
 	/* TODO: Destroy all the supplemental_page_table hold by thread and
 	* TODO: writeback all the modified contents to the storage. */
-	// hash_destroy(&spt->pages, page_dealloc);
-	hash_clear(&spt->pages, page_dealloc);
+	/* Do all file I/O first, so that the frame table is not held across
+	 * disk writes. */
+	spt_writeback (spt);
+
+	/* Then drop every page in one go.  The page tables themselves are
+	 * destroyed right after this by process_cleanup(). */
+	spt->dying = true;
+	lock_acquire (&frame_table_lock);
+	vamap_clear (&spt->pages, page_dealloc, NULL);
+	lock_release (&frame_table_lock);
+	spt->dying = false;
+
+	vma_kill_all (spt);
 }
 
-void page_dealloc(struct hash_elem *e, void *aux UNUSED) {
-	struct page *target = hash_entry (e, struct page, page_elem);
+void page_dealloc(void *page_, void *aux UNUSED) {
+	struct page *target = page_;
 	destroy(target);
     free(target);
-}
\ No newline at end of file
+}
+/* Counts one STAT event for the current thread and for the system. */
+void
+vm_stat_inc (enum vm_stat stat) {
+	ASSERT (stat < VM_STAT_CNT);
+	vm_stats[stat]++;
+	if (!intr_context ())
+		thread_current ()->vm_stats[stat]++;
+}
+
+/* Returns counter STAT, system-wide if GLOBAL, else of the current thread. */
+long long
+vm_stat_get (enum vm_stat stat, bool global) {
+	if (stat >= VM_STAT_CNT)
+		return -1;
+	return global ? vm_stats[stat] : thread_current ()->vm_stats[stat];
+}
+
+/* Prints VM statistics. */
+void
+vm_print_stats (void) {
+	printf ("VM: %lld faults (%lld major, %lld minor), %lld stack growths, "
+			"%lld zero page maps\n",
+			vm_stats[VM_STAT_FAULTS], vm_stats[VM_STAT_MAJOR_FAULTS],
+			vm_stats[VM_STAT_MINOR_FAULTS], vm_stats[VM_STAT_STACK_GROWTHS],
+			vm_stats[VM_STAT_ZERO_MAPS]);
+	printf ("VM: %lld evictions, %lld swap ins, %lld swap outs, "
+			"%lld zswap loads, %lld zswap stores\n",
+			vm_stats[VM_STAT_EVICTIONS], vm_stats[VM_STAT_SWAP_INS],
+			vm_stats[VM_STAT_SWAP_OUTS], vm_stats[VM_STAT_ZSWAP_LOADS],
+			vm_stats[VM_STAT_ZSWAP_STORES]);
+}
+
+/* Tool for tuning working sets. Calling this function via int 0x45.
+ * Input:
+ *   @RDX - Counter to read, one of enum vm_stat
+ *   @RCX - 0 for the current process, nonzero for the whole system
+ * Output:
+ *   @RAX - Value of the counter, or -1 for an unknown counter. */
+static void
+inspect_vm_stat (struct intr_frame *f) {
+	f->R.rax = vm_stat_get (f->R.rdx, f->R.rcx != 0);
+}
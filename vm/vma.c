@@ -0,0 +1,293 @@
+/* vma.c: Regions of a process's virtual address space.
+ *
+ * Each supplemental page table keeps its regions in an AVL tree keyed by
+ * the start address.  Every node also records the largest end address of
+ * its subtree, which turns the tree into an interval tree: finding the
+ * region that contains an address or that overlaps a range only visits
+ * O(log n) nodes, no matter how many pages the regions span. */
+
+#include "vm/vm.h"
+#include "vm/vma.h"
+#include <string.h>
+#include "vm/shm.h"
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/vaddr.h"
+
+static int
+height (struct vm_area *a) {
+	return a != NULL ? a->height : 0;
+}
+
+static void *
+max_end (struct vm_area *a) {
+	return a != NULL ? a->max_end : NULL;
+}
+
+/* Recomputes the cached height and max_end of A from its children. */
+static void
+update (struct vm_area *a) {
+	int hl = height (a->left), hr = height (a->right);
+	void *ml = max_end (a->left), *mr = max_end (a->right);
+
+	a->height = (hl > hr ? hl : hr) + 1;
+	a->max_end = a->end;
+	if (ml > a->max_end)
+		a->max_end = ml;
+	if (mr > a->max_end)
+		a->max_end = mr;
+}
+
+static struct vm_area *
+rotate_right (struct vm_area *a) {
+	struct vm_area *l = a->left;
+	a->left = l->right;
+	l->right = a;
+	update (a);
+	update (l);
+	return l;
+}
+
+static struct vm_area *
+rotate_left (struct vm_area *a) {
+	struct vm_area *r = a->right;
+	a->right = r->left;
+	r->left = a;
+	update (a);
+	update (r);
+	return r;
+}
+
+/* Restores the AVL invariant at A and returns the new subtree root. */
+static struct vm_area *
+balance (struct vm_area *a) {
+	update (a);
+	int diff = height (a->left) - height (a->right);
+	if (diff > 1) {
+		if (height (a->left->left) < height (a->left->right))
+			a->left = rotate_left (a->left);
+		return rotate_right (a);
+	}
+	if (diff < -1) {
+		if (height (a->right->right) < height (a->right->left))
+			a->right = rotate_right (a->right);
+		return rotate_left (a);
+	}
+	return a;
+}
+
+static struct vm_area *
+insert (struct vm_area *root, struct vm_area *a) {
+	if (root == NULL)
+		return a;
+	if (a->start < root->start)
+		root->left = insert (root->left, a);
+	else
+		root->right = insert (root->right, a);
+	return balance (root);
+}
+
+/* Detaches the leftmost node of ROOT into *MIN. */
+static struct vm_area *
+remove_min (struct vm_area *root, struct vm_area **min) {
+	if (root->left == NULL) {
+		*min = root;
+		return root->right;
+	}
+	root->left = remove_min (root->left, min);
+	return balance (root);
+}
+
+static struct vm_area *
+remove (struct vm_area *root, struct vm_area *a) {
+	if (root == NULL)
+		return NULL;
+	if (a->start < root->start)
+		root->left = remove (root->left, a);
+	else if (a->start > root->start)
+		root->right = remove (root->right, a);
+	else {
+		struct vm_area *l = root->left, *r = root->right, *min;
+		if (r == NULL)
+			return l;
+		r = remove_min (r, &min);
+		min->left = l;
+		min->right = r;
+		return balance (min);
+	}
+	return balance (root);
+}
+
+/* Returns a region of the subtree ROOT that intersects [START, END),
+ * or NULL if there is none. */
+static struct vm_area *
+find_overlap (struct vm_area *root, const void *start, const void *end) {
+	while (root != NULL) {
+		if (root->start < end && start < root->end)
+			return root;
+		if (root->left != NULL && start < root->left->max_end)
+			root = root->left;
+		else
+			root = root->right;
+	}
+	return NULL;
+}
+
+/* Creates a region [START, END) of TYPE in SPT.  If FILE is non-null the
+ * region gets its own reopened handle on it and the first READ_BYTES bytes
+ * of the region are read from FILE starting at OFS; the rest is zeroed.
+ * Returns NULL if the range overlaps an existing region or on allocation
+ * failure. */
+struct vm_area *
+vma_create (struct supplemental_page_table *spt, void *start, void *end,
+		enum vm_type type, bool writable, struct file *file, off_t ofs,
+		size_t read_bytes) {
+	ASSERT (pg_ofs (start) == 0 && pg_ofs (end) == 0);
+
+	if (start >= end || !is_user_vaddr (start)
+			|| !is_user_vaddr ((uint8_t *) end - 1)
+			|| vma_overlaps (spt, start, end))
+		return NULL;
+
+	struct vm_area *a = malloc (sizeof *a);
+	if (a == NULL)
+		return NULL;
+	*a = (struct vm_area) {
+		.start = start,
+		.end = end,
+		.type = type,
+		.writable = writable,
+		.file = NULL,
+		.ofs = ofs,
+		.read_bytes = read_bytes,
+		.shm = NULL,
+	};
+	if (file != NULL && (a->file = file_reopen (file)) == NULL) {
+		free (a);
+		return NULL;
+	}
+	list_init (&a->pages);
+	update (a);
+
+	spt->areas = insert (spt->areas, a);
+	return a;
+}
+
+/* Frees AREA, dropping what it holds on to. */
+static void
+release (struct vm_area *area) {
+	if (area->shm != NULL) {
+		shm_unmap (area);
+		shm_put (area->shm);
+	}
+	file_close (area->file);
+	free (area);
+}
+
+/* Removes AREA from SPT, destroying every page materialized in it (which
+ * writes dirty file-backed pages back) and closing its file. */
+void
+vma_destroy (struct supplemental_page_table *spt, struct vm_area *area) {
+	while (!list_empty (&area->pages)) {
+		struct page *page = list_entry (list_pop_front (&area->pages),
+				struct page, area_elem);
+		spt_remove_page (spt, page);
+	}
+	spt->areas = remove (spt->areas, area);
+	if (spt->stack == area)
+		spt->stack = NULL;
+	release (area);
+}
+
+static void
+free_subtree (struct vm_area *a) {
+	if (a == NULL)
+		return;
+	free_subtree (a->left);
+	free_subtree (a->right);
+	release (a);
+}
+
+/* Frees every region of SPT.  Their pages must already be destroyed. */
+void
+vma_kill_all (struct supplemental_page_table *spt) {
+	free_subtree (spt->areas);
+	spt->areas = NULL;
+	spt->stack = NULL;
+}
+
+/* Returns the region of SPT containing VA, or NULL. */
+struct vm_area *
+vma_find (struct supplemental_page_table *spt, const void *va) {
+	return find_overlap (spt->areas, va, (const uint8_t *) va + 1);
+}
+
+/* Returns true if any region of SPT intersects [START, END). */
+bool
+vma_overlaps (struct supplemental_page_table *spt, const void *start,
+		const void *end) {
+	return find_overlap (spt->areas, start, end) != NULL;
+}
+
+/* Returns the lowest region of SPT, or NULL if it has none. */
+struct vm_area *
+vma_first (struct supplemental_page_table *spt) {
+	struct vm_area *a = spt->areas;
+	while (a != NULL && a->left != NULL)
+		a = a->left;
+	return a;
+}
+
+/* Returns the region of SPT that follows AREA in address order. */
+struct vm_area *
+vma_next (struct supplemental_page_table *spt, struct vm_area *area) {
+	struct vm_area *a = spt->areas, *next = NULL;
+	while (a != NULL) {
+		if (a->start > area->start) {
+			next = a;
+			a = a->left;
+		} else
+			a = a->right;
+	}
+	return next;
+}
+
+/* Grows AREA downward so that it starts at NEW_START.  Fails if the
+ * grown part would overlap another region. */
+bool
+vma_extend_down (struct supplemental_page_table *spt, struct vm_area *area,
+		void *new_start) {
+	ASSERT (pg_ofs (new_start) == 0);
+
+	if (new_start >= area->start)
+		return true;
+	if (!is_user_vaddr (new_start)
+			|| vma_overlaps (spt, new_start, area->start))
+		return false;
+
+	/* Lowering START keeps AREA between the same neighbours and leaves END
+	 * alone, so neither the tree order nor any cached max_end changes. */
+	area->start = new_start;
+	return true;
+}
+
+/* Page initializer for pages of a region: fills the page from the
+ * region's file, if any, and zeroes the remainder.  AUX is the region. */
+bool
+vma_load_page (struct page *page, void *aux) {
+	struct vm_area *area = aux;
+	uint8_t *kpage = page->frame->kva;
+	size_t offset = (uint8_t *) page->va - (uint8_t *) area->start;
+	size_t page_read_bytes = 0;
+
+	if (area->file != NULL && offset < area->read_bytes)
+		page_read_bytes = area->read_bytes - offset < PGSIZE
+			? area->read_bytes - offset : PGSIZE;
+
+	if (page_read_bytes > 0
+			&& file_read_at (area->file, kpage, page_read_bytes,
+				area->ofs + offset) != (off_t) page_read_bytes)
+		return false;
+	memset (kpage + page_read_bytes, 0, PGSIZE - page_read_bytes);
+	return true;
+}
@@ -0,0 +1,254 @@
+/* zswap.c: Compressed RAM cache in front of the swap disk.
+ *
+ * Evicted anonymous pages are compressed with a small LZ77 codec and kept
+ * in a fixed arena of kernel pages, carved into 64-byte blocks that are
+ * handed out with a bitmap.  An entry is a run of blocks starting with a
+ * 16-bit length followed by the compressed bytes; its handle is the
+ * index of its first block.
+ *
+ * The codec uses an LZ4-like sequence format.  Each sequence is a token
+ * byte whose high nibble is the literal count and low nibble the match
+ * length minus ZSWAP_MIN_MATCH (15 in either meaning "more bytes
+ * follow, each adding up to 255"), the literals, and for every sequence
+ * but the last a 16-bit little-endian match offset.  The last sequence
+ * carries only literals and ends exactly at PGSIZE. */
+
+#include "vm/zswap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <string.h>
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Pages of kernel memory used for compressed pages. */
+#define ZSWAP_POOL_PAGES 64
+
+/* Allocation unit within the arena. */
+#define ZSWAP_BLOCK_SIZE 64
+#define ZSWAP_BLOCK_CNT (ZSWAP_POOL_PAGES * PGSIZE / ZSWAP_BLOCK_SIZE)
+
+/* Pages that compress worse than this go straight to disk. */
+#define ZSWAP_MAX_SIZE (PGSIZE * 3 / 4)
+
+#define ZSWAP_MIN_MATCH 4
+#define ZSWAP_HASH_BITS 10
+#define ZSWAP_NO_POS UINT16_MAX
+
+static uint8_t *arena;                  /* ZSWAP_POOL_PAGES pages. */
+static struct bitmap *used_blocks;      /* Blocks of ARENA in use. */
+static struct lock zswap_lock;          /* Protects everything here. */
+
+/* Scratch space for the compressor, only used with ZSWAP_LOCK held.
+ * Both are too large for a kernel stack. */
+static uint16_t hash_table[1 << ZSWAP_HASH_BITS];
+static uint8_t scratch[ZSWAP_MAX_SIZE];
+
+/* Sets up the arena.  If the memory cannot be spared the cache stays
+ * disabled and every page goes to disk. */
+void
+zswap_init (void) {
+	lock_init (&zswap_lock);
+	lock_profile (&zswap_lock, "zswap");
+	arena = palloc_get_multiple (0, ZSWAP_POOL_PAGES);
+	if (arena == NULL)
+		return;
+	used_blocks = bitmap_create (ZSWAP_BLOCK_CNT);
+	if (used_blocks == NULL) {
+		palloc_free_multiple (arena, ZSWAP_POOL_PAGES);
+		arena = NULL;
+	}
+}
+
+static uint32_t
+read32 (const uint8_t *p) {
+	uint32_t v;
+	memcpy (&v, p, sizeof v);
+	return v;
+}
+
+static unsigned
+hash4 (const uint8_t *p) {
+	return (read32 (p) * 2654435761u) >> (32 - ZSWAP_HASH_BITS);
+}
+
+/* Appends the extension bytes of length LEN >= 15 to *OP. */
+static bool
+put_length (uint8_t **op, const uint8_t *end, size_t len) {
+	for (len -= 15; ; len -= 255) {
+		if (*op >= end)
+			return false;
+		*(*op)++ = len < 255 ? len : 255;
+		if (len < 255)
+			return true;
+	}
+}
+
+/* Appends a sequence of LIT_LEN literals from LIT followed, if MATCH_LEN
+ * is nonzero, by a match of MATCH_LEN bytes at distance OFFSET. */
+static bool
+put_sequence (uint8_t **op, const uint8_t *end, const uint8_t *lit,
+		size_t lit_len, size_t offset, size_t match_len) {
+	size_t ml = match_len != 0 ? match_len - ZSWAP_MIN_MATCH : 0;
+
+	if (*op >= end)
+		return false;
+	*(*op)++ = (lit_len < 15 ? lit_len : 15) << 4 | (ml < 15 ? ml : 15);
+	if (lit_len >= 15 && !put_length (op, end, lit_len))
+		return false;
+	if ((size_t) (end - *op) < lit_len)
+		return false;
+	memcpy (*op, lit, lit_len);
+	*op += lit_len;
+
+	if (match_len == 0)
+		return true;
+	if (end - *op < 2)
+		return false;
+	*(*op)++ = offset & 0xff;
+	*(*op)++ = offset >> 8;
+	return ml < 15 || put_length (op, end, ml);
+}
+
+/* Compresses the page at SRC into DST, which holds CAP bytes.  Returns
+ * the compressed size, or 0 if it does not fit. */
+static size_t
+compress (const uint8_t *src, uint8_t *dst, size_t cap) {
+	uint8_t *op = dst, *end = dst + cap;
+	size_t ip = 0, anchor = 0;
+
+	memset (hash_table, 0xff, sizeof hash_table);
+	while (ip + ZSWAP_MIN_MATCH <= PGSIZE) {
+		unsigned h = hash4 (src + ip);
+		size_t ref = hash_table[h];
+		hash_table[h] = ip;
+
+		if (ref == ZSWAP_NO_POS || read32 (src + ref) != read32 (src + ip)) {
+			ip++;
+			continue;
+		}
+
+		size_t len = ZSWAP_MIN_MATCH;
+		while (ip + len < PGSIZE && src[ref + len] == src[ip + len])
+			len++;
+		if (!put_sequence (&op, end, src + anchor, ip - anchor, ip - ref, len))
+			return 0;
+		ip += len;
+		anchor = ip;
+	}
+	if (anchor < PGSIZE
+			&& !put_sequence (&op, end, src + anchor, PGSIZE - anchor, 0, 0))
+		return 0;
+	return op - dst;
+}
+
+/* Reads a length that continues with extension bytes after 15. */
+static bool
+get_length (const uint8_t *src, size_t size, size_t *ip, size_t *len) {
+	uint8_t b;
+	do {
+		if (*ip >= size)
+			return false;
+		b = src[(*ip)++];
+		*len += b;
+	} while (b == 255);
+	return true;
+}
+
+/* Decompresses SIZE bytes at SRC into the page at DST. */
+static bool
+decompress (const uint8_t *src, size_t size, uint8_t *dst) {
+	size_t ip = 0, op = 0;
+
+	while (op < PGSIZE) {
+		if (ip >= size)
+			return false;
+		uint8_t token = src[ip++];
+
+		size_t lit_len = token >> 4;
+		if (lit_len == 15 && !get_length (src, size, &ip, &lit_len))
+			return false;
+		if (lit_len > size - ip || lit_len > PGSIZE - op)
+			return false;
+		memcpy (dst + op, src + ip, lit_len);
+		ip += lit_len;
+		op += lit_len;
+		if (op == PGSIZE)
+			break;
+
+		if (size - ip < 2)
+			return false;
+		size_t offset = src[ip] | src[ip + 1] << 8;
+		ip += 2;
+		size_t len = token & 15;
+		if (len == 15 && !get_length (src, size, &ip, &len))
+			return false;
+		len += ZSWAP_MIN_MATCH;
+		if (offset == 0 || offset > op || len > PGSIZE - op)
+			return false;
+
+		/* The match may overlap the bytes it produces. */
+		for (; len > 0; len--, op++)
+			dst[op] = dst[op - offset];
+	}
+	return true;
+}
+
+static size_t
+block_cnt (size_t bytes) {
+	return DIV_ROUND_UP (bytes, ZSWAP_BLOCK_SIZE);
+}
+
+/* Compresses the page at KVA into the cache.  Returns a handle for
+ * zswap_load(), or -1 if the page does not compress well enough or the
+ * cache has no room for it. */
+int
+zswap_store (const void *kva) {
+	int idx = -1;
+
+	if (arena == NULL)
+		return -1;
+
+	lock_acquire (&zswap_lock);
+	size_t size = compress (kva, scratch, sizeof scratch);
+	if (size != 0) {
+		size_t cnt = block_cnt (sizeof (uint16_t) + size);
+		size_t start = bitmap_scan_and_flip (used_blocks, 0, cnt, false);
+		if (start != BITMAP_ERROR) {
+			uint8_t *entry = arena + start * ZSWAP_BLOCK_SIZE;
+			uint16_t len = size;
+			memcpy (entry, &len, sizeof len);
+			memcpy (entry + sizeof len, scratch, size);
+			idx = start;
+		}
+	}
+	lock_release (&zswap_lock);
+	return idx;
+}
+
+/* Decompresses entry IDX into the page at KVA.  The entry is kept. */
+bool
+zswap_load (int idx, void *kva) {
+	ASSERT (arena != NULL && idx >= 0 && idx < ZSWAP_BLOCK_CNT);
+
+	const uint8_t *entry = arena + idx * ZSWAP_BLOCK_SIZE;
+	uint16_t len;
+	memcpy (&len, entry, sizeof len);
+	return decompress (entry + sizeof len, len, kva);
+}
+
+/* Releases entry IDX. */
+void
+zswap_free (int idx) {
+	ASSERT (arena != NULL && idx >= 0 && idx < ZSWAP_BLOCK_CNT);
+
+	const uint8_t *entry = arena + idx * ZSWAP_BLOCK_SIZE;
+	uint16_t len;
+	memcpy (&len, entry, sizeof len);
+
+	lock_acquire (&zswap_lock);
+	bitmap_set_multiple (used_blocks, idx, block_cnt (sizeof len + len), false);
+	lock_release (&zswap_lock);
+}